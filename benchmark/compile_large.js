@@ -0,0 +1,58 @@
+// Generates a large module and the same code as a classic script, then
+// imports the module, reporting the time until its first statement ran and
+// the longest the event loop was blocked meanwhile.
+//
+// Run the generated files directly to compare time-to-first-eval from
+// process start, where the script is streamed to V8 and the module isn't:
+//
+//   zero benchmark/.compile_large.module.js
+//   zero --mode script benchmark/.compile_large.script.js
+//
+// Usage: compile_large.js [megabytes]
+
+const [megabytes = 5] = environment.argv.slice(1).map(Number);
+const moduleURL = new URL('.compile_large.module.js', import.meta.url);
+const scriptURL = new URL('.compile_large.script.js', import.meta.url);
+
+const generate = (exportPrefix) => {
+  const functions = [];
+  let length = 0;
+  for (let i = 0; length < megabytes * 1024 * 1024; i += 1) {
+    const f = `${exportPrefix}function f${i}(a, b) {
+  const values = [a, b, ${i}, 'f${i}'];
+  return values.map((v) => typeof v === 'number' ? v * 2 : \`\${v}!\`).join(',');
+}
+`;
+    functions.push(f);
+    length += f.length;
+  }
+  return `global.firstEval = performance.now();
+// eslint-disable-next-line no-console
+console.log(\`first eval after \${global.firstEval}ms\`);
+${functions.join('')}`;
+};
+
+(async () => {
+  await fileSystem.writeFile(moduleURL, generate('export '));
+  await fileSystem.writeFile(scriptURL, generate(''));
+
+  let longestGap = 0;
+  let last = performance.now();
+  let loading = true;
+  const tick = () => {
+    const now = performance.now();
+    longestGap = Math.max(longestGap, now - last);
+    last = now;
+    if (loading) {
+      setTimeout(tick, 0);
+    }
+  };
+  setTimeout(tick, 0);
+
+  const start = performance.now();
+  await import(`${moduleURL}`);
+  loading = false;
+  // eslint-disable-next-line no-console
+  console.log(`module: first eval ${(global.firstEval - start).toFixed(1)}ms ` +
+              `after import(), loop blocked for up to ${longestGap.toFixed(1)}ms`);
+})();
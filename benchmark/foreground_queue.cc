@@ -0,0 +1,164 @@
+// Post-to-run latency of the foreground task queue.
+//
+// A number of producer threads post timestamped tasks to the loop thread,
+// which runs them from a uv_async_t callback the way PerIsolatePlatformData
+// does. Two queues are compared:
+//
+//   mutex: std::queue behind a mutex, uv_async_send after every push
+//   mpsc:  MpscQueue, uv_async_send only when no wakeup is pending
+//
+// With an interval, each producer waits that many microseconds between posts,
+// which measures latency on an idle loop rather than under saturation.
+//
+// Usage: bench_foreground_queue [producers] [tasks per producer] [interval us]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "uv.h"
+#include "zero_mpsc_queue.h"
+
+namespace {
+
+struct Task {
+  uint64_t posted;
+};
+
+class MutexQueue {
+ public:
+  MutexQueue() { uv_mutex_init(&mutex_); }
+  ~MutexQueue() { uv_mutex_destroy(&mutex_); }
+
+  void Post(std::unique_ptr<Task> task, uv_async_t* async) {
+    uv_mutex_lock(&mutex_);
+    tasks_.push(std::move(task));
+    uv_async_send(async);
+    uv_mutex_unlock(&mutex_);
+  }
+
+  void Drain(std::queue<std::unique_ptr<Task>>* out) {
+    uv_mutex_lock(&mutex_);
+    tasks_.swap(*out);
+    uv_mutex_unlock(&mutex_);
+  }
+
+ private:
+  uv_mutex_t mutex_;
+  std::queue<std::unique_ptr<Task>> tasks_;
+};
+
+class LockFreeQueue {
+ public:
+  void Post(std::unique_ptr<Task> task, uv_async_t* async) {
+    tasks_.Push(std::move(task));
+    if (!pending_.exchange(true, std::memory_order_acq_rel)) {
+      uv_async_send(async);
+    }
+  }
+
+  void Drain(std::queue<std::unique_ptr<Task>>* out) {
+    pending_.exchange(false, std::memory_order_acq_rel);
+    while (std::unique_ptr<Task> task = tasks_.Pop()) {
+      out->push(std::move(task));
+    }
+  }
+
+ private:
+  zero::MpscQueue<Task> tasks_;
+  std::atomic<bool> pending_{false};
+};
+
+template <class Queue>
+struct State {
+  Queue queue;
+  uv_async_t async;
+  size_t expected;
+  std::vector<uint64_t> latencies;
+};
+
+template <class Queue>
+void OnAsync(uv_async_t* handle) {
+  auto state = static_cast<State<Queue>*>(handle->data);
+  std::queue<std::unique_ptr<Task>> tasks;
+  state->queue.Drain(&tasks);
+  while (!tasks.empty()) {
+    state->latencies.push_back(uv_hrtime() - tasks.front()->posted);
+    tasks.pop();
+  }
+  if (state->latencies.size() == state->expected) {
+    uv_close(reinterpret_cast<uv_handle_t*>(handle), nullptr);
+  }
+}
+
+template <class Queue>
+void Run(const char* name, int producers, int tasks, int interval) {
+  uv_loop_t loop;
+  uv_loop_init(&loop);
+
+  State<Queue> state;
+  state.expected = static_cast<size_t>(producers) * tasks;
+  state.latencies.reserve(state.expected);
+  state.async.data = &state;
+  uv_async_init(&loop, &state.async, OnAsync<Queue>);
+
+  uint64_t start = uv_hrtime();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < producers; i += 1) {
+    threads.emplace_back([&state, tasks, interval]() {
+      for (int j = 0; j < tasks; j += 1) {
+        if (interval > 0) {
+          uint64_t until = uv_hrtime() + interval * 1000ull;
+          while (uv_hrtime() < until) {}
+        }
+        std::unique_ptr<Task> task(new Task());
+        task->posted = uv_hrtime();
+        state.queue.Post(std::move(task), &state.async);
+      }
+    });
+  }
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  uint64_t elapsed = uv_hrtime() - start;
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  uv_loop_close(&loop);
+
+  std::vector<uint64_t>& l = state.latencies;
+  std::sort(l.begin(), l.end());
+  printf("%-6s %9.0f tasks/s   p50 %8.1fus   p99 %8.1fus   max %8.1fus\n",
+         name,
+         l.size() / (elapsed / 1e9),
+         l[l.size() / 2] / 1e3,
+         l[l.size() * 99 / 100] / 1e3,
+         l.back() / 1e3);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int producers = argc > 1 ? atoi(argv[1]) : 4;
+  int tasks = argc > 2 ? atoi(argv[2]) : 100000;
+  int interval = argc > 3 ? atoi(argv[3]) : 0;
+  if (producers < 1 || tasks < 1 || interval < 0) {
+    fprintf(stderr,
+            "usage: %s [producers] [tasks per producer] [interval us]\n",
+            argv[0]);
+    return 1;
+  }
+
+  printf("%d producers, %d tasks each, %dus interval\n",
+         producers, tasks, interval);
+  Run<MutexQueue>("mutex", producers, tasks, interval);
+  Run<LockFreeQueue>("mpsc", producers, tasks, interval);
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+// Random 4 KiB reads from a 64 MiB file with many requests in flight, for
+// comparing the fs backends:
+//
+//   out/zero --fs-backend=threadpool benchmark/fs_random_read.js
+//   out/zero --fs-backend=io_uring benchmark/fs_random_read.js
+//
+// Usage: fs_random_read.js [reads] [concurrency]
+
+const kFileSize = 64 * 1024 * 1024;
+const kBlockSize = 4096;
+
+const [reads = 100000, concurrency = 64] = environment.argv.slice(1).map(Number);
+const path = new URL('.fs_random_read.tmp', import.meta.url);
+
+(async () => {
+  await fileSystem.writeFile(path, new Uint8Array(kFileSize).fill(1));
+  const handle = await fileSystem.open(path, { write: false });
+
+  const blocks = kFileSize / kBlockSize;
+  const latencies = [];
+  let issued = 0;
+
+  const worker = async () => {
+    const into = new Uint8Array(kBlockSize);
+    while (issued < reads) {
+      issued += 1;
+      const position = Math.floor(Math.random() * blocks) * kBlockSize;
+      const start = performance.now();
+      await handle.read({ into, position }); // eslint-disable-line no-await-in-loop
+      latencies.push(performance.now() - start);
+    }
+  };
+
+  const start = performance.now();
+  await Promise.all(Array.from({ length: concurrency }, worker));
+  const elapsed = performance.now() - start;
+
+  await handle.close();
+  await fileSystem.removeFile(path);
+
+  latencies.sort((a, b) => a - b);
+  const at = (p) => latencies[Math.floor(latencies.length * p)].toFixed(3);
+  console.log(`${reads} reads, ${concurrency} in flight: ` + // eslint-disable-line no-console
+    `${Math.round(reads / (elapsed / 1000))} reads/s, ` +
+    `p50 ${at(0.5)}ms, p99 ${at(0.99)}ms`);
+})();
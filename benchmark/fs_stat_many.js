@@ -0,0 +1,28 @@
+// Stats a list of paths with one stat() per path and with a single
+// statMany() call.
+//
+// Usage: fs_stat_many.js [paths] [rounds]
+
+const [paths = 10000, rounds = 5] = environment.argv.slice(1).map(Number);
+const url = new URL('.fs_stat_many.tmp', import.meta.url);
+
+const time = async (name, fn) => {
+  const start = performance.now();
+  for (let i = 0; i < rounds; i += 1) {
+    await fn(); // eslint-disable-line no-await-in-loop
+  }
+  const elapsed = (performance.now() - start) / rounds;
+  const rate = Math.round(paths / (elapsed / 1000));
+  // eslint-disable-next-line no-console
+  console.log(`${name}: ${elapsed.toFixed(1)}ms, ${rate} stats/s`);
+};
+
+(async () => {
+  await fileSystem.writeFile(url, '');
+  const urls = Array.from({ length: paths }, () => url);
+
+  await time('stat', () => Promise.all(urls.map((u) => fileSystem.stat(u))));
+  await time('statMany', () => fileSystem.statMany(urls));
+
+  await fileSystem.removeFile(url);
+})();
@@ -1,6 +1,6 @@
 'use strict';
 
-({ binding, load, process, PrivateSymbol: PS }) => {
+({ namespace, binding, load, process, PrivateSymbol: PS }) => {
   const { isLittleEndian } = process;
 
   const ffi = binding('ffi');
@@ -271,10 +271,5 @@
     return o;
   }
 
-  Object.defineProperty(global, 'DynamicLibrary', {
-    value: DynamicLibrary,
-    enumerable: false,
-    configurable: true,
-    writable: true,
-  });
+  namespace.DynamicLibrary = DynamicLibrary;
 };
@@ -8,13 +8,26 @@
     close,
     stat: _stat,
     fstat: _fstat,
+    statMany,
+    fsync,
     read,
+    readInto,
+    readv,
     write,
+    writev,
+    readFile,
+    writeFile,
+    copyRange,
+    sendfile,
     scandir,
+    opendir,
+    readdir,
+    closedir,
     rmdir,
     unlink,
     mkdir,
     symlink,
+    readlink,
     rename,
     copy,
     futime,
@@ -39,6 +52,7 @@
     // S_IFREG,
     // S_IFSOCK,
     UV_FS_COPYFILE_EXCL,
+    UV_FS_COPYFILE_FICLONE,
     UV_DIRENT_UNKNOWN,
     UV_DIRENT_FILE,
     UV_DIRENT_DIR,
@@ -47,13 +61,36 @@
     UV_DIRENT_SOCKET,
     UV_DIRENT_CHAR,
     UV_DIRENT_BLOCK,
+    UV_EEXIST,
     UV_FS_EVENT_WATCH_ENTRY,
     UV_FS_EVENT_RECURSIVE,
+    kStatDev,
+    kStatMode,
+    kStatNlink,
+    kStatUid,
+    kStatGid,
+    kStatRdev,
+    kStatIno,
+    kStatSize,
+    kStatBlksize,
+    kStatBlocks,
+    kStatFlags,
+    kStatGen,
+    kStatATime,
+    kStatMTime,
+    kStatCTime,
+    kStatBirthTime,
+    kStatError,
+    kStatFields,
   } = binding('fs');
   const { WeakRef } = binding('util');
+  const mmap = binding('mmap');
+  const { Walker } = binding('walk');
 
   const kFD = PS('kFD');
   const kHandle = PS('kHandle');
+  const kReadable = PS('kReadable');
+  const kWritable = PS('kWritable');
 
   const uvTypeToReadable = {
     [UV_DIRENT_UNKNOWN]: 'unknown',
@@ -68,26 +105,29 @@
 
   const DEFAULT_MODE = 0o666;
 
-  const nsFromTimeSpecBigInt = (sec, nsec) => (sec * 1000000000n) + nsec;
-
-  const convertStats = (array) => ({
-    dev: array[0],
-    mode: array[1],
-    nlink: array[2],
-    uid: array[3],
-    gid: array[4],
-    rdev: array[5],
-    ino: array[6],
-    size: array[7],
-    blksize: array[8],
-    blocks: array[9],
-    flags: array[10],
-    gen: array[11],
-    atim: nsFromTimeSpecBigInt(array[12], array[13]),
-    mtim: nsFromTimeSpecBigInt(array[14], array[15]),
-    ctim: nsFromTimeSpecBigInt(array[16], array[17]),
-    birthtim: nsFromTimeSpecBigInt(array[18], array[19]),
-  });
+  // Reads the |index|th result written by stat, fstat or statMany. The time
+  // slots hold nanoseconds as int64, read through |times|.
+  const convertStats = (fields, times, index = 0) => {
+    const base = index * kStatFields;
+    return {
+      dev: fields[base + kStatDev],
+      mode: fields[base + kStatMode],
+      nlink: fields[base + kStatNlink],
+      uid: fields[base + kStatUid],
+      gid: fields[base + kStatGid],
+      rdev: fields[base + kStatRdev],
+      ino: fields[base + kStatIno],
+      size: fields[base + kStatSize],
+      blksize: fields[base + kStatBlksize],
+      blocks: fields[base + kStatBlocks],
+      flags: fields[base + kStatFlags],
+      gen: fields[base + kStatGen],
+      atim: times[base + kStatATime],
+      mtim: times[base + kStatMTime],
+      ctim: times[base + kStatCTime],
+      birthtim: times[base + kStatBirthTime],
+    };
+  };
 
   const stats2human = (stats) => ({
     isDir: (stats.mode & S_IFMT) === S_IFDIR,
@@ -105,13 +145,80 @@
   });
 
   const stat = async (f) => {
-    const stats = await _stat(f);
-    return convertStats(stats);
+    const fields = new Float64Array(kStatFields);
+    await _stat(f, fields);
+    return convertStats(fields, new BigInt64Array(fields.buffer));
   };
 
   const fstat = async (f) => {
-    const stats = await _fstat(f);
-    return convertStats(stats);
+    const fields = new Float64Array(kStatFields);
+    await _fstat(f, fields);
+    return convertStats(fields, new BigInt64Array(fields.buffer));
+  };
+
+  // Yields the entries below |path| in batches of { path, type }, where path
+  // is relative to |path|. Directories are read in parallel on the
+  // threadpool, and a directory always comes before its contents.
+  async function* walk(path, {
+    maxDepth = Infinity,
+    followSymlinks = false,
+    concurrency = 4,
+  } = {}) {
+    const walker = new Walker(path, Math.max(maxDepth, 1), followSymlinks, concurrency);
+    try {
+      for (;;) {
+        const batch = await walker.next(); // eslint-disable-line no-await-in-loop
+        if (batch === null) {
+          return;
+        }
+        const [paths, types] = batch;
+        yield paths.map((p, i) => ({ path: p, type: uvTypeToReadable[types[i]] }));
+      }
+    } finally {
+      walker.close();
+    }
+  }
+
+  // Yields the entries of the directory at |path| in batches of up to
+  // |batchSize| { name, type } objects, reading only one batch at a time.
+  async function* openDirectory(path, batchSize) {
+    const dir = await opendir(path);
+    try {
+      for (;;) {
+        // eslint-disable-next-line no-await-in-loop
+        const [names, types] = await readdir(dir, batchSize);
+        if (names.length === 0) {
+          return;
+        }
+        yield names.map((name, i) => ({ name, type: uvTypeToReadable[types[i]] }));
+      }
+    } finally {
+      await closedir(dir);
+    }
+  }
+
+  const createDirectory = async (path, mode, ignoreExisting) => {
+    try {
+      await mkdir(path, mode);
+    } catch (e) {
+      if (!ignoreExisting || e.code !== UV_EEXIST) {
+        throw e;
+      }
+    }
+  };
+
+  // Creates a symbolic link at |to| with the same target as the one at |from|.
+  const copyLink = async (from, to, overwrite) => {
+    const target = await readlink(from);
+    try {
+      await symlink(target, to);
+    } catch (e) {
+      if (!overwrite || e.code !== UV_EEXIST) {
+        throw e;
+      }
+      await unlink(to);
+      await symlink(target, to);
+    }
   };
 
   const { defineIDLClass } = load('util');
@@ -121,6 +228,13 @@
   const decoders = new Map();
   const encoder = new TextEncoder();
 
+  const getDecoder = (encoding) => {
+    if (!decoders.has(encoding)) {
+      decoders.set(encoding, new TextDecoder(encoding));
+    }
+    return decoders.get(encoding);
+  };
+
   class FileSystemManager {}
 
   const resolvePath = (url) => {
@@ -130,6 +244,129 @@
     return getFilePathFromURL(url);
   };
 
+  const kReadChunkSize = 64 * 1024;
+
+  // Reads in growing chunks until a short read rather than asking fstat for
+  // the size first. Most files fit in the first chunk.
+  const readToEnd = async (fd, position) => {
+    const chunks = [];
+    let total = 0;
+    let size = kReadChunkSize;
+    for (;;) {
+      const at = position === -1 ? -1 : position + total;
+      const chunk = await read(fd, size, at); // eslint-disable-line no-await-in-loop
+      chunks.push(chunk);
+      total += chunk.length;
+      if (chunk.length < size) {
+        break;
+      }
+      size *= 2;
+    }
+    if (chunks.length === 1) {
+      return chunks[0];
+    }
+    const buffer = new Uint8Array(total);
+    let offset = 0;
+    chunks.forEach((chunk) => {
+      buffer.set(chunk, offset);
+      offset += chunk.length;
+    });
+    return buffer;
+  };
+
+  // Underlying byte source for FileHandle.readable. Once a chunk has been
+  // handed to the stream, the next one is already requested from the
+  // threadpool so that reading overlaps with the consumer. No readahead is
+  // started while the stream's queue is above its highWaterMark.
+  class FileSource {
+    constructor(fd, chunkSize, position) {
+      this.type = 'bytes';
+      this.fd = fd;
+      this.chunkSize = chunkSize;
+      this.position = position;
+      this.readahead = undefined;
+    }
+
+    advance(n) {
+      if (this.position !== -1) {
+        this.position += n;
+      }
+    }
+
+    async readChunk() {
+      const chunk = await read(this.fd, this.chunkSize, this.position);
+      this.advance(chunk.length);
+      return chunk;
+    }
+
+    async pull(controller) {
+      const { byobRequest } = controller;
+      let chunk;
+      if (this.readahead !== undefined) {
+        chunk = await this.readahead;
+        this.readahead = undefined;
+      } else if (byobRequest) {
+        // read straight into the reader's buffer
+        const n = await readInto(this.fd, byobRequest.view, this.position);
+        this.advance(n);
+        if (n === 0) {
+          controller.close();
+        }
+        byobRequest.respond(n);
+        return;
+      } else {
+        chunk = await this.readChunk();
+      }
+
+      if (chunk.length === 0) {
+        controller.close();
+        if (byobRequest) {
+          byobRequest.respond(0);
+        }
+        return;
+      }
+      controller.enqueue(chunk);
+
+      if (controller.desiredSize >= 0) {
+        this.readahead = this.readChunk();
+        // errors surface from the pull that awaits it
+        this.readahead.catch(() => {});
+      }
+    }
+  }
+
+  // Underlying sink for FileHandle.writable.
+  class FileSink {
+    constructor(fd, position) {
+      this.fd = fd;
+      this.position = position;
+    }
+
+    async write(chunk) {
+      let view = typeof chunk === 'string' ? encoder.encode(chunk) : chunk;
+      if (!ArrayBuffer.isView(view)) {
+        throw new TypeError('chunk must be a string or an ArrayBufferView');
+      }
+      while (view.byteLength > 0) {
+        const n = await write(this.fd, this.position, view); // eslint-disable-line no-await-in-loop
+        if (this.position !== -1) {
+          this.position += n;
+        }
+        view = new Uint8Array(view.buffer, view.byteOffset + n, view.byteLength - n);
+      }
+    }
+  }
+
+  const kDefaultChunkSize = 64 * 1024;
+
+  // Transfers read from an explicit offset; there is no "current position"
+  // for the source.
+  const checkPosition = (position) => {
+    if (!Number.isSafeInteger(position) || position < 0) {
+      throw new RangeError('position must be a non-negative integer');
+    }
+  };
+
   class FileHandle {
     constructor(fd) {
       this[kFD] = fd;
@@ -169,21 +406,26 @@
       return new FileHandle(fd);
     }
 
+    // With `into`, reads into the given ArrayBufferView and returns the number
+    // of bytes read. Otherwise returns a new Uint8Array of at most `size`
+    // bytes, or of everything up to the end of the file.
     async read({
       size = undefined,
       position = -1,
       encoding = undefined,
+      into = undefined,
     } = {}) {
-      if (size === undefined) {
-        const stats = await fstat(this[kFD]);
-        ({ size } = stats);
+      if (into !== undefined) {
+        if (!ArrayBuffer.isView(into)) {
+          throw new TypeError('into must be an ArrayBufferView');
+        }
+        return readInto(this[kFD], into, position);
       }
-      const buffer = await read(this[kFD], size, position);
+      const buffer = size === undefined ?
+        await readToEnd(this[kFD], position) :
+        await read(this[kFD], size, position);
       if (encoding !== undefined) {
-        if (!decoders.has(encoding)) {
-          decoders.set(encoding, new TextDecoder(encoding));
-        }
-        return decoders.get(encoding).decode(buffer);
+        return getDecoder(encoding).decode(buffer);
       }
       return buffer;
     }
@@ -197,20 +439,164 @@
       await write(this[kFD], position, buffer);
     }
 
+    // Fills each view in `views` in order and returns the total number of
+    // bytes read.
+    async readv(views, {
+      position = -1,
+    } = {}) {
+      if (!Array.isArray(views) || !views.every((v) => ArrayBuffer.isView(v))) {
+        throw new TypeError('views must be an array of ArrayBufferViews');
+      }
+      // libuv rejects an empty list of buffers
+      if (views.length === 0) {
+        return 0;
+      }
+      return readv(this[kFD], views, position);
+    }
+
+    // Writes each buffer in `buffers` back to back without concatenating
+    // them first and returns the number of bytes written.
+    async writev(buffers, {
+      position = -1,
+    } = {}) {
+      if (!Array.isArray(buffers)) {
+        throw new TypeError('buffers must be an array');
+      }
+      const views = buffers.map((b) => (typeof b === 'string' ? encoder.encode(b) : b));
+      if (!views.every((v) => ArrayBuffer.isView(v))) {
+        throw new TypeError('buffers must be strings or ArrayBufferViews');
+      }
+      if (views.length === 0) {
+        return 0;
+      }
+      return writev(this[kFD], position, views);
+    }
+
     async stat() {
       const stats = await fstat(this[kFD]);
       return stats2human(stats);
     }
 
+    // Copies `length` bytes from `position` in this file to the FileHandle
+    // `target` at `targetPosition` (-1 for its current position) without
+    // passing through JS, and returns the number of bytes copied. The kernel
+    // does the copy, or shares extents between the files, where it can.
+    async copyTo(target, {
+      position = 0,
+      length = undefined,
+      targetPosition = -1,
+    } = {}) {
+      if (!(target instanceof FileHandle)) {
+        throw new TypeError('target must be a FileHandle');
+      }
+      checkPosition(position);
+      if (length === undefined) {
+        length = Math.max((await fstat(this[kFD])).size - position, 0);
+      }
+      return copyRange(this[kFD], position, target[kFD], targetPosition, length);
+    }
+
+    // Sends `length` bytes from `position` in this file to `target`, a
+    // FileHandle or a descriptor such as a socket, pipe or TTY, without
+    // passing through JS. Returns the number of bytes sent.
+    async sendTo(target, {
+      position = 0,
+      length = undefined,
+    } = {}) {
+      const fd = target instanceof FileHandle ? target[kFD] : target;
+      if (!Number.isInteger(fd) || fd < 0) {
+        throw new TypeError('target must be a FileHandle or a file descriptor');
+      }
+      checkPosition(position);
+      if (length === undefined) {
+        length = Math.max((await fstat(this[kFD])).size - position, 0);
+      }
+      return sendfile(this[kFD], fd, position, length);
+    }
+
     async setDates({ accessDate, modificationDate }) {
       await futime(this[kFD], accessDate, modificationDate);
     }
 
+    async sync() {
+      await fsync(this[kFD]);
+    }
+
+    // Returns a byte stream over the file, which supports BYOB readers. The
+    // handle stays open when the stream ends.
+    createReadable({
+      chunkSize = kDefaultChunkSize,
+      highWaterMark = chunkSize,
+      position = -1,
+    } = {}) {
+      const { ReadableStream } = load('whatwg/streams/readable');
+      const source = new FileSource(this[kFD], chunkSize, position);
+      return new ReadableStream(source, { highWaterMark });
+    }
+
+    // Returns a stream that writes each chunk to the file in order. Queued
+    // bytes are limited by highWaterMark. The handle stays open when the
+    // stream is closed.
+    createWritable({
+      highWaterMark = kDefaultChunkSize,
+      position = -1,
+    } = {}) {
+      const { WritableStream } = load('whatwg/streams/writable');
+      return new WritableStream(new FileSink(this[kFD], position), {
+        highWaterMark,
+        size: (chunk) => (typeof chunk === 'string' ? chunk.length : chunk.byteLength),
+      });
+    }
+
+    get readable() {
+      if (this[kReadable] === undefined) {
+        this[kReadable] = this.createReadable();
+      }
+      return this[kReadable];
+    }
+
+    get writable() {
+      if (this[kWritable] === undefined) {
+        this[kWritable] = this.createWritable();
+      }
+      return this[kWritable];
+    }
+
     async close() {
       await close(this[kFD]);
     }
   }
 
+  const adviceFromHint = {
+    normal: mmap.MADV_NORMAL,
+    sequential: mmap.MADV_SEQUENTIAL,
+    random: mmap.MADV_RANDOM,
+    willneed: mmap.MADV_WILLNEED,
+    dontneed: mmap.MADV_DONTNEED,
+  };
+
+  // A file region mapped into memory. `buffer` reads (and, for writable
+  // mappings, writes) the file directly. The region is unmapped by unmap()
+  // or once the buffer is garbage collected. Changes to a read-only mapping
+  // stay private to the process.
+  class FileMapping {
+    constructor(buffer) {
+      this.buffer = buffer;
+    }
+
+    advise(hint) {
+      const advice = adviceFromHint[hint];
+      if (advice === undefined) {
+        throw new TypeError(`unknown hint ${hint}`);
+      }
+      mmap.advise(this.buffer, advice);
+    }
+
+    unmap() {
+      return mmap.unmap(this.buffer);
+    }
+  }
+
   class FileWatcher {
     constructor(url, cb, {
       entryOnly = false,
@@ -243,17 +629,30 @@
   defineIDLClass(FileSystemManager, undefined, {
     open: FileHandle.open,
 
-    async readFile(url, options) {
-      const handle = await FileHandle.open(url);
-      const buf = await handle.read(options);
-      await handle.close();
-      return buf;
+    async readFile(url, options = {}) {
+      if (options.size !== undefined || options.position !== undefined) {
+        const handle = await FileHandle.open(url, { write: false });
+        try {
+          return await handle.read(options);
+        } finally {
+          await handle.close();
+        }
+      }
+      const buffer = await readFile(resolvePath(url));
+      if (options.encoding !== undefined) {
+        return getDecoder(options.encoding).decode(buffer);
+      }
+      return buffer;
     },
 
-    async writeFile(url, buffer, options) {
-      const handle = await FileHandle.open(url);
-      await handle.write(buffer, options);
-      await handle.close();
+    async writeFile(url, buffer, {
+      append = false,
+      sync = false,
+    } = {}) {
+      if (typeof buffer === 'string') {
+        buffer = encoder.encode(buffer);
+      }
+      await writeFile(resolvePath(url), buffer, append, sync);
     },
     async removeFile(url, {
       ignoreAbsent = false,
@@ -278,12 +677,74 @@
       const stats = await stat(path);
       return stats2human(stats);
     },
+    // Stats many paths in parallel. Paths that can't be stat()ed give null.
+    async statMany(urls) {
+      const paths = urls.map(resolvePath);
+      const fields = new Float64Array(paths.length * kStatFields);
+      await statMany(paths, fields);
+      const times = new BigInt64Array(fields.buffer);
+      return paths.map((path, i) => {
+        if (fields[(i * kStatFields) + kStatError] !== 0) {
+          return null;
+        }
+        return stats2human(convertStats(fields, times, i));
+      });
+    },
     async copy(from, to, {
       noOverwrite = false,
+      recursive = false,
     } = {}) {
       const fromPath = resolvePath(from);
       const toPath = resolvePath(to);
-      await copy(fromPath, toPath, noOverwrite ? UV_FS_COPYFILE_EXCL : 0);
+      // FICLONE shares extents with the source where the file system
+      // supports it and falls back to copying otherwise.
+      const flags = UV_FS_COPYFILE_FICLONE | (noOverwrite ? UV_FS_COPYFILE_EXCL : 0);
+      if (!recursive || ((await stat(fromPath)).mode & S_IFMT) !== S_IFDIR) {
+        await copy(fromPath, toPath, flags);
+        return;
+      }
+      // Symbolic links below |from| are recreated with the same target rather
+      // than followed, so links to directories and dangling links copy too.
+      await createDirectory(toPath, 0o777, !noOverwrite);
+      for await (const batch of walk(fromPath)) {
+        const entries = [];
+        for (const entry of batch) {
+          if (entry.type === 'directory') {
+            // parents come first, so create these in order
+            // eslint-disable-next-line no-await-in-loop
+            await createDirectory(`${toPath}/${entry.path}`, 0o777, !noOverwrite);
+          } else {
+            entries.push(entry);
+          }
+        }
+        await Promise.all(entries.map(({ path, type }) => { // eslint-disable-line no-await-in-loop
+          const source = `${fromPath}/${path}`;
+          const target = `${toPath}/${path}`;
+          if (type === 'link') {
+            return copyLink(source, target, !noOverwrite);
+          }
+          return copy(source, target, flags);
+        }));
+      }
+    },
+    // Copies part of one file into another, creating it if needed, and
+    // returns the number of bytes copied. See FileHandle#copyTo.
+    async copyRange(from, to, {
+      position = 0,
+      length = undefined,
+      targetPosition = 0,
+    } = {}) {
+      const source = await FileHandle.open(from, { write: false });
+      try {
+        const target = await FileHandle.open(to, { read: false, create: true });
+        try {
+          return await source.copyTo(target, { position, length, targetPosition });
+        } finally {
+          await target.close();
+        }
+      } finally {
+        await source.close();
+      }
     },
     async move(from, to) {
       const fromPath = resolvePath(from);
@@ -304,39 +765,78 @@
         return false;
       }
     },
+    async map(url, {
+      offset = 0,
+      length = undefined,
+      writable = false,
+    } = {}) {
+      const path = resolvePath(url);
+      const fd = await open(path, writable ? O_RDWR : O_RDONLY, 0);
+      try {
+        const { size } = await fstat(fd);
+        if (length === undefined) {
+          length = size - offset;
+        }
+        if (!Number.isSafeInteger(offset) || !Number.isSafeInteger(length) ||
+            offset < 0 || length < 0 || offset + length > size) {
+          // pages past the end of the file fault when touched
+          throw new RangeError('mapping must lie within the file');
+        }
+        return new FileMapping(mmap.map(fd, offset, length, writable));
+      } finally {
+        // the mapping stays valid after the descriptor is closed
+        await close(fd);
+      }
+    },
     watch(url, cb, options) {
       return new FileWatcher(url, cb, options);
     },
+    walk(url, options) {
+      return walk(resolvePath(url), options);
+    },
 
     async createDirectory(url, {
       ignoreExisting = false,
       unixMode = DEFAULT_MODE,
     } = {}) {
       const path = resolvePath(url);
-      try {
-        await mkdir(path, unixMode);
-      } catch (e) {
-        if (!ignoreExisting || e.code !== 'EEXIST') {
-          throw e;
-        }
-      }
+      await createDirectory(path, unixMode, ignoreExisting);
     },
     async removeDirectory(url, {
       recursive = false,
     } = {}) {
       const path = resolvePath(url);
       if (recursive) {
-        const items = await this.readDirectory(path);
-        await Promise.all(items.map(async ([name]) => {
-          try {
-            await unlink(name);
-          } catch (e) {
-            await this.removeDirectory(name, { recursive });
+        // Files go as they are found. Directories are removed afterwards,
+        // deepest first, once they are empty.
+        const levels = [];
+        for await (const batch of walk(path)) {
+          // eslint-disable-next-line no-await-in-loop
+          await Promise.all(batch.map(({ path: p, type }) => {
+            if (type === 'directory') {
+              const depth = p.split('/').length;
+              (levels[depth] || (levels[depth] = [])).push(p);
+              return undefined;
+            }
+            return unlink(`${path}/${p}`);
+          }));
+        }
+        for (let depth = levels.length - 1; depth > 0; depth -= 1) {
+          if (levels[depth] !== undefined) {
+            // eslint-disable-next-line no-await-in-loop
+            await Promise.all(levels[depth].map((p) => rmdir(`${path}/${p}`)));
           }
-        }));
-      } else {
-        await rmdir(path);
+        }
+      }
+      await rmdir(path);
+    },
+    openDirectory(url, {
+      batchSize = 256,
+    } = {}) {
+      if (!Number.isInteger(batchSize) || batchSize < 1) {
+        throw new RangeError('batchSize must be a positive integer');
       }
+      return openDirectory(resolvePath(url), batchSize);
     },
     async readDirectory(url) {
       const path = resolvePath(url);
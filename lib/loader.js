@@ -4,15 +4,17 @@
   const {
     setImportModuleDynamicallyCallback,
     setInitializeImportMetaObjectCallback,
+    scanImports,
   } = binding('module_wrap');
   const { URL } = load('whatwg/url');
+  const { TextDecoder } = load('whatwg/encoding');
+  const { fileSystem } = load('file_system');
 
   const { ModuleJob } = load('loader/module_job');
   const { translators } = load('loader/translators');
-  const { AsyncQueue } = load('util');
-  const { fileSystem } = load('file_system');
-
-  const statQueue = new AsyncQueue(10);
+  const compileCache = load('loader/compile_cache');
+  const resolutionCache = load('loader/resolution_cache');
+  const { openBundle } = load('loader/bundle');
 
   class ModuleMap extends Map {
     constructor() {
@@ -30,15 +32,100 @@
     }
   }
 
+  // created on first use: a TextDecoder holds a native handle, which must not
+  // end up in the startup snapshot
+  let decoder;
+  const getDecoder = () => {
+    if (decoder === undefined) {
+      decoder = new TextDecoder('utf-8');
+    }
+    return decoder;
+  };
+
   class Loader {
     constructor(parentURL) {
       this.parentURL = parentURL;
       this.moduleMap = new ModuleMap();
+      // url -> Promise of the source of a module that has been read but not
+      // yet compiled
+      this.sources = new Map();
+      // number of graphs being loaded by runJob()
+      this.loading = 0;
+      this.bundles = [];
+    }
+
+    // Returns the bundle holding the module at `url`, if any.
+    findBundle(url) {
+      return this.bundles.find((bundle) => bundle.contains(url));
+    }
+
+    // Opens the bundle at `url` and imports its entry point. Imports from
+    // bundled modules are resolved from the bundle alone.
+    async importBundle(url) {
+      const bundle = await openBundle(url);
+      this.bundles.push(bundle);
+      return this.import(bundle.entry);
+    }
+
+    // Starts reading the module at `url` and, as soon as it arrives, every
+    // module it statically imports, found by scanning the source rather
+    // than compiling it. The reads of a whole graph are in flight at once,
+    // instead of one level of the graph per round of compiles.
+    prefetch(url) {
+      if (this.moduleMap.has(url) || this.sources.has(url)) {
+        return;
+      }
+      const source = fileSystem.readFile(url).then((bytes) => {
+        scanImports(bytes).forEach((specifier) => {
+          this.resolve(specifier, url)
+            .then((resolved) => {
+              if (this.loading > 0 && resolved.format === 'esm' &&
+                  /^file:/.test(resolved.url)) {
+                this.prefetch(resolved.url);
+              }
+            })
+            // reported when the importing module is linked
+            .catch(() => {});
+        });
+        return getDecoder().decode(bytes);
+      });
+      // reported when the module itself is translated
+      source.catch(() => {});
+      this.sources.set(url, source);
+    }
+
+    // Returns the source of the module at `url`, which prefetch() may have
+    // already read.
+    readSource(url) {
+      this.prefetch(url);
+      const source = this.sources.get(url);
+      this.sources.delete(url);
+      return source;
+    }
+
+    // Loads and evaluates the graph rooted at `specifier`. Sources that
+    // prefetch() read but nothing compiled, such as scanner hits that do not
+    // resolve to a module of the graph or the rest of a graph that failed to
+    // link, are dropped once no graph is loading. The compile cache is
+    // flushed whenever a graph settles, whether it was evaluated or not.
+    async runJob(specifier, referrer) {
+      this.loading += 1;
+      try {
+        const job = await this.getModuleJob(specifier, referrer);
+        const { result } = await job.run();
+        return { job, result };
+      } finally {
+        this.loading -= 1;
+        if (this.loading === 0) {
+          this.sources.clear();
+        }
+        compileCache.flush(this.loading === 0);
+      }
     }
 
     async import(specifier, referrer) {
-      const job = await this.getModuleJob(specifier, referrer);
-      await job.run();
+      const { job } = await this.runJob(specifier, referrer);
+      resolutionCache.flushManifest();
       return job.module.getNamespace();
     }
 
@@ -54,41 +141,26 @@
         return { url: specifier, format: 'esm' };
       }
 
+      const bundle = this.findBundle(referrer);
+      if (bundle !== undefined) {
+        return { url: bundle.resolve(specifier, referrer), format: 'bundle' };
+      }
+      if (this.findBundle(specifier) !== undefined) {
+        return { url: specifier, format: 'bundle' };
+      }
+
       const url = new URL(specifier, referrer);
 
       if (url.protocol === 'file:') {
-        const handler = async (ext, format) => {
-          const exists = await statQueue.add(() => fileSystem.exists(`${url}.${ext}`));
-          if (exists) {
-            return {
-              url: `${url}.${ext}`,
-              format,
-            };
-          }
-
-          return null;
-        };
-
-        const resolved = (await Promise.all([
-          statQueue.add(async () => {
-            const exists = await fileSystem.exists(url);
-            if (exists) {
-              return {
-                url: `${url}`,
-                format: 'esm',
-              };
-            }
-            return null;
-          }),
-          handler('js', 'esm'),
-          handler('mjs', 'esm'),
-        ])).find((a) => a !== null);
-
-        if (!resolved) {
+        const resolved = await resolutionCache.resolveFile(specifier, referrer, url);
+        if (resolved === null) {
           throw new Error(`unable to resolve ${specifier}`);
         }
 
-        return resolved;
+        return {
+          url: resolved,
+          format: 'esm',
+        };
       }
 
       return {
@@ -104,7 +176,7 @@
         return this.moduleMap.get(url);
       }
 
-      const translation = translators.get(format)(url);
+      const translation = translators.get(format)(url, this);
 
       const job = new ModuleJob(this, url, translation);
 
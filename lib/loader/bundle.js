@@ -0,0 +1,210 @@
+'use strict';
+
+// Single file application bundles. A bundle holds the source and V8 code
+// cache of every module in a static import graph along with how each of
+// their imports resolved, so that an application can start from one mapped
+// file without reading or resolving anything else.
+//
+// Layout, with all numbers unsigned 32 bit integers in the byte order of the
+// machine that made the bundle:
+//
+//   0   "ZEROBNDL"
+//   8   format version
+//   12  0x01020304, to detect a foreign byte order
+//   16  cachedDataVersionTag of the V8 that made the code caches
+//   20  length of the index
+//   24  index, as UTF-8 JSON
+//       data, starting at the next multiple of 8
+//
+// The index looks like
+//
+//   {
+//     "entry": "main.js",
+//     "modules": {
+//       "main.js": {
+//         "source": [offset, length],
+//         "twoByte": false,
+//         "cache": [offset, length] or null,
+//         "imports": { "./util.js": "lib/util.js" }
+//       }
+//     }
+//   }
+//
+// with module paths relative to the bundle and offsets relative to the start
+// of the data. Sources are Latin-1 when they can be, or else UTF-16, so that
+// they can be handed to V8 as external strings pointing into the mapping.
+// Modules get the URL of the bundle followed by their path, so
+// `app.zb/main.js` for the entry of `app.zb`.
+
+({ namespace, binding, load }) => {
+  const { ModuleWrap } = binding('module_wrap');
+  const { cachedDataVersionTag } = binding('script_wrap');
+  const { externalString } = binding('mmap');
+  const { TextDecoder, TextEncoder } = load('whatwg/encoding');
+  const { fileSystem } = load('file_system');
+
+  const kMagic = 'ZEROBNDL';
+  const kVersion = 1;
+  const kByteOrder = 0x01020304;
+  const kHeaderSize = 24;
+
+  const align = (n) => Math.ceil(n / 8) * 8;
+
+  // created on first use, to keep its native handle out of the snapshot
+  let decoder;
+  const getDecoder = () => {
+    if (decoder === undefined) {
+      decoder = new TextDecoder('utf-8');
+    }
+    return decoder;
+  };
+  const encoder = new TextEncoder();
+
+  class Bundle {
+    constructor(url, mapping) {
+      const { buffer } = mapping;
+      if (buffer.byteLength < kHeaderSize ||
+          getDecoder().decode(new Uint8Array(buffer, 0, 8)) !== kMagic) {
+        throw new TypeError(`${url} is not a bundle`);
+      }
+      const [version, byteOrder, tag, indexLength] = new Uint32Array(buffer, 8, 4);
+      if (version !== kVersion) {
+        throw new RangeError(`${url} has unsupported version ${version}`);
+      }
+      if (byteOrder !== kByteOrder) {
+        throw new RangeError(`${url} was made on a machine with a different byte order`);
+      }
+      const indexBytes = new Uint8Array(buffer, kHeaderSize, indexLength);
+      const index = JSON.parse(getDecoder().decode(indexBytes));
+
+      this.mapping = mapping;
+      this.prefix = `${url}/`;
+      this.entry = `${this.prefix}${index.entry}`;
+      this.dataOffset = align(kHeaderSize + indexLength);
+      // caches from another V8 would only be rejected
+      this.useCache = tag === cachedDataVersionTag();
+      this.modules = new Map(Object.entries(index.modules).map(([path, record]) =>
+        [path, { ...record, imports: new Map(Object.entries(record.imports)) }]));
+
+      mapping.advise('willneed');
+    }
+
+    contains(url) {
+      return url.startsWith(this.prefix) && this.modules.has(url.slice(this.prefix.length));
+    }
+
+    // Answers from the table recorded when the bundle was made. Anything that
+    // wasn't imported statically back then can't be resolved.
+    resolve(specifier, referrer) {
+      const { imports } = this.modules.get(referrer.slice(this.prefix.length));
+      const path = imports.get(specifier);
+      if (path === undefined) {
+        throw new Error(`unable to resolve ${specifier} in bundle`);
+      }
+      return `${this.prefix}${path}`;
+    }
+
+    compile(url) {
+      const { source, twoByte, cache } = this.modules.get(url.slice(this.prefix.length));
+      const { buffer } = this.mapping;
+      const text = externalString(buffer, this.dataOffset + source[0], source[1], twoByte);
+      const data = cache !== null && this.useCache ?
+        new Uint8Array(buffer, this.dataOffset + cache[0], cache[1]) :
+        undefined;
+      return new ModuleWrap(text, url, data);
+    }
+  }
+
+  namespace.openBundle = async (url) => new Bundle(`${url}`, await fileSystem.map(url));
+
+  const encodeSource = (source) => {
+    let max = 0;
+    for (let i = 0; i < source.length; i += 1) {
+      max = Math.max(max, source.charCodeAt(i));
+    }
+    const twoByte = max > 0xFF;
+    const chars = twoByte ? new Uint16Array(source.length) : new Uint8Array(source.length);
+    for (let i = 0; i < source.length; i += 1) {
+      chars[i] = source.charCodeAt(i);
+    }
+    return { bytes: new Uint8Array(chars.buffer), twoByte };
+  };
+
+  // Writes a bundle of `entry` and every module it statically imports to
+  // `output`, resolving imports with `loader`. The code caches cover what
+  // V8 compiles eagerly; nothing is evaluated.
+  namespace.createBundle = async (loader, entry, output) => {
+    const modules = new Map();
+
+    const visit = async (url) => {
+      if (modules.has(url)) {
+        return;
+      }
+      const record = { imports: new Map() };
+      modules.set(url, record);
+
+      record.source = getDecoder().decode(await fileSystem.readFile(url));
+      const wrap = new ModuleWrap(record.source, url);
+      record.cache = wrap.createCachedData();
+
+      await Promise.all(wrap.getStaticDependencySpecifiers().map(async (specifier) => {
+        if (/^data:/.test(specifier)) {
+          return;
+        }
+        const resolved = await loader.resolve(specifier, url);
+        if (resolved.format !== 'esm' || !/^file:/.test(resolved.url)) {
+          throw new Error(`unable to bundle ${specifier} imported by ${url}`);
+        }
+        record.imports.set(specifier, resolved.url);
+        await visit(resolved.url);
+      }));
+    };
+
+    const { url: entryURL } = await loader.resolve(entry);
+    await visit(entryURL);
+
+    // paths are relative to the deepest directory containing every module
+    let root = entryURL.slice(0, entryURL.lastIndexOf('/') + 1);
+    modules.forEach((record, url) => {
+      while (!url.startsWith(root)) {
+        root = root.slice(0, root.lastIndexOf('/', root.length - 2) + 1);
+      }
+    });
+    const relative = (url) => url.slice(root.length);
+
+    const blobs = [];
+    let dataLength = 0;
+    const add = (bytes) => {
+      const offset = dataLength;
+      blobs.push({ offset, bytes });
+      dataLength = align(offset + bytes.byteLength);
+      return [offset, bytes.byteLength];
+    };
+
+    const index = { entry: relative(entryURL), modules: {} };
+    modules.forEach((record, url) => {
+      const { bytes, twoByte } = encodeSource(record.source);
+      index.modules[relative(url)] = {
+        source: add(bytes),
+        twoByte,
+        cache: record.cache === undefined ? null : add(record.cache),
+        imports: [...record.imports].reduce((imports, [specifier, resolved]) => {
+          imports[specifier] = relative(resolved);
+          return imports;
+        }, {}),
+      };
+    });
+    const indexBytes = encoder.encode(JSON.stringify(index));
+
+    const dataOffset = align(kHeaderSize + indexBytes.byteLength);
+    const file = new Uint8Array(dataOffset + dataLength);
+    file.set(encoder.encode(kMagic), 0);
+    file.set(new Uint8Array(new Uint32Array([
+      kVersion, kByteOrder, cachedDataVersionTag(), indexBytes.byteLength,
+    ]).buffer), 8);
+    file.set(indexBytes, kHeaderSize);
+    blobs.forEach(({ offset, bytes }) => file.set(bytes, dataOffset + offset));
+
+    await fileSystem.writeFile(output, file);
+  };
+};
@@ -0,0 +1,153 @@
+'use strict';
+
+// On-disk V8 code cache for user modules and scripts. Disabled unless a
+// directory is configured with --compile-cache or ZERO_COMPILE_CACHE.
+
+({ namespace, binding, load, process }) => {
+  const { ModuleWrap, kEvaluated, kErrored } = binding('module_wrap');
+  const {
+    run,
+    runWithCache,
+    runStreaming,
+    cachedDataVersionTag,
+  } = binding('script_wrap');
+  const { fileSystem } = load('file_system');
+  const { getFilePathFromURL } = load('whatwg/url');
+
+  const stats = {
+    hits: 0,
+    misses: 0,
+    rejected: 0,
+  };
+
+  let root;
+  let directory;
+  let directoryCreated;
+  let pending = [];
+
+  // FNV-1a and djb2 side by side, giving a 64 bit key.
+  const hash = (string) => {
+    let a = 0x811c9dc5;
+    let b = 5381;
+    for (let i = 0; i < string.length; i += 1) {
+      const c = string.charCodeAt(i);
+      a = Math.imul(a ^ c, 0x01000193);
+      b = Math.imul(b, 33) ^ c;
+    }
+    return `${(a >>> 0).toString(16).padStart(8, '0')}${(b >>> 0).toString(16).padStart(8, '0')}`;
+  };
+
+  const getCacheFile = (url, source) =>
+    `${directory}/${hash(`${url}`)}${hash(source)}.cache`;
+
+  const read = async (file) => {
+    try {
+      return await fileSystem.readFile(file);
+    } catch (e) {
+      return undefined;
+    }
+  };
+
+  // Writes to a temporary file first so that concurrent processes never
+  // observe a partially written cache.
+  const write = async (file, data) => {
+    if (data === undefined) {
+      return;
+    }
+    try {
+      if (directoryCreated === undefined) {
+        directoryCreated = (async () => {
+          await fileSystem.createDirectory(root, { ignoreExisting: true });
+          await fileSystem.createDirectory(directory, { ignoreExisting: true });
+        })();
+      }
+      await directoryCreated;
+      const temp = `${file}.${Math.random().toString(36).slice(2)}`;
+      await fileSystem.writeFile(temp, data);
+      await fileSystem.move(temp, file);
+    } catch (e) {
+      // the cache is best effort
+    }
+  };
+
+  namespace.configure = (dir) => {
+    root = dir.startsWith('/') ? dir : `${process.cwd}/${dir}`;
+    directory = `${root}/v8-${process.versions.v8}-${cachedDataVersionTag()}`;
+  };
+
+  namespace.getStats = () => ({ ...stats, directory });
+
+  namespace.compileModule = async (url, source) => {
+    if (directory === undefined) {
+      return new ModuleWrap(source, url);
+    }
+
+    const file = getCacheFile(url, source);
+    const data = await read(file);
+    const wrap = new ModuleWrap(source, url, data);
+
+    if (data === undefined) {
+      stats.misses += 1;
+    } else if (wrap.cachedDataRejected) {
+      stats.rejected += 1;
+    } else {
+      stats.hits += 1;
+      return wrap;
+    }
+
+    pending.push({ wrap, file });
+    return wrap;
+  };
+
+  // Called whenever a module graph settles. Evaluated modules are written
+  // then, so that the cache also covers the functions that were compiled
+  // lazily during evaluation. Modules that failed to evaluate are dropped. The rest are kept for a later flush while
+  // other graphs are loading, but dropped once `settled`, since then they
+  // belong to graphs that failed to link and will never be evaluated.
+  namespace.flush = (settled) => {
+    const entries = pending;
+    pending = [];
+    return Promise.all(entries.map(({ wrap, file }) => {
+      const status = wrap.getStatus();
+      if (status === kEvaluated) {
+        return write(file, wrap.createCachedData());
+      }
+      if (status !== kErrored && !settled) {
+        pending.push({ wrap, file });
+      }
+      return undefined;
+    }));
+  };
+
+  namespace.runScript = async (url, source) => {
+    if (directory === undefined) {
+      return run(`${url}`, source);
+    }
+
+    const file = getCacheFile(url, source);
+    const data = await read(file);
+
+    const { result, cachedDataRejected, cachedData } = runWithCache(`${url}`, source, data);
+
+    if (data === undefined) {
+      stats.misses += 1;
+    } else if (cachedDataRejected) {
+      stats.rejected += 1;
+    } else {
+      stats.hits += 1;
+    }
+    await write(file, cachedData);
+
+    return result;
+  };
+
+  // Runs the script file at `url`. Without a cache, it is streamed to V8,
+  // which parses it on a background thread while it is read.
+  namespace.runScriptFile = async (url) => {
+    if (directory === undefined) {
+      return runStreaming(`${url}`, getFilePathFromURL(url));
+    }
+    const source = await fileSystem.readFile(url, { encoding: 'utf8' });
+    return namespace.runScript(url, source);
+  };
+};
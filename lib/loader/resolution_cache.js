@@ -0,0 +1,217 @@
+'use strict';
+
+// Memoizes module resolution. Whether a candidate file exists is answered
+// from a listing of its directory, read once, instead of a stat per
+// candidate, and each result, failures included, is kept per specifier and
+// referrer directory. invalidate() forgets what is known about a directory,
+// for example from a FileWatcher callback.
+//
+// Everything resolved can be written out as a manifest, which is an import
+// map whose `imports` map each URL as imported, before .js or .mjs is tried,
+// to the file it resolved to:
+//
+//   { "imports": { "file:///app/util": "file:///app/util.js" } }
+//
+// Once a manifest is loaded, the URLs it lists resolve with one lookup and
+// without looking at the file system. Others are resolved as usual.
+
+({ namespace, load }) => {
+  const { fileSystem } = load('file_system');
+  const { getFilePathFromURL, URL } = load('whatwg/url');
+
+  const stats = {
+    hits: 0,
+    misses: 0,
+    listings: 0,
+    invalidations: 0,
+    manifestHits: 0,
+  };
+
+  // key -> Promise of the resolved URL, or of null if nothing matched
+  const resolutions = new Map();
+  // directory path -> Promise of a Set of names, or of null if unreadable
+  const listings = new Map();
+  // directory path -> keys of the resolutions that looked into it
+  const dependents = new Map();
+  // URL -> resolved URL, from a loaded manifest
+  const manifest = new Map();
+  // URL -> resolved URL, of everything resolved so far
+  const resolved = new Map();
+  let manifestLoading;
+  let manifestOutput;
+  let manifestDirty = false;
+
+  const record = (href, file) => {
+    if (resolved.get(href) !== file) {
+      resolved.set(href, file);
+      manifestDirty = true;
+    }
+  };
+
+  const split = (path) => {
+    const slash = path.lastIndexOf('/');
+    return [path.slice(0, slash) || '/', path.slice(slash + 1)];
+  };
+
+  const getListing = (dir) => {
+    let listing = listings.get(dir);
+    if (listing === undefined) {
+      stats.listings += 1;
+      listing = fileSystem.readDirectory(dir)
+        .then((entries) => new Set(entries.map(({ name }) => name)), () => null);
+      listings.set(dir, listing);
+    }
+    return listing;
+  };
+
+  const lookup = async (key, url) => {
+    const [dir, base] = split(getFilePathFromURL(url));
+    if (!dependents.has(dir)) {
+      dependents.set(dir, new Set());
+    }
+    dependents.get(dir).add(key);
+
+    const names = await getListing(dir);
+    if (names === null) {
+      return null;
+    }
+    if (names.has(base)) {
+      return `${url}`;
+    }
+    if (names.has(`${base}.js`)) {
+      return `${url}.js`;
+    }
+    if (names.has(`${base}.mjs`)) {
+      return `${url}.mjs`;
+    }
+    return null;
+  };
+
+  const resolve = (specifier, referrer, url) => {
+    const key = `${referrer.slice(0, referrer.lastIndexOf('/') + 1)}\n${specifier}`;
+    let result = resolutions.get(key);
+    if (result !== undefined) {
+      stats.hits += 1;
+      return result;
+    }
+    stats.misses += 1;
+    result = lookup(key, url);
+    resolutions.set(key, result);
+    // errors, unlike missing files, are not cached
+    result.catch(() => resolutions.delete(key));
+    return result;
+  };
+
+  // Resolves with the URL of the file `specifier` refers to from
+  // `referrer`, trying `url` as is and then with .js and .mjs appended, or
+  // with null if none of them exist.
+  namespace.resolveFile = (specifier, referrer, url) => {
+    if (manifestLoading !== undefined) {
+      return manifestLoading.then(() => namespace.resolveFile(specifier, referrer, url));
+    }
+    const href = `${url}`;
+    const mapped = manifest.get(href);
+    if (mapped !== undefined) {
+      stats.manifestHits += 1;
+      record(href, mapped);
+      return Promise.resolve(mapped);
+    }
+    const result = resolve(specifier, referrer, url);
+    result.then((file) => {
+      if (file !== null) {
+        record(href, file);
+      }
+    }, () => {});
+    return result;
+  };
+
+  // Keys and values may be relative to the manifest, as in an import map.
+  // Anything but file URLs, such as bare specifiers, is skipped.
+  const parseManifestURL = (value, base) => {
+    if (typeof value !== 'string') {
+      return undefined;
+    }
+    let href;
+    if (/^\.{0,2}\//.test(value)) {
+      href = `${new URL(value, base)}`;
+    } else if (/^file:/i.test(value)) {
+      href = `${new URL(value)}`;
+    }
+    return href;
+  };
+
+  // Adds the entries of the manifest at `url`. Resolutions wait for it.
+  namespace.loadManifest = (url) => {
+    const loading = fileSystem.readFile(url, { encoding: 'utf8' })
+      .then((text) => {
+        const { imports = {} } = JSON.parse(text);
+        Object.keys(imports).forEach((key) => {
+          const from = parseManifestURL(key, url);
+          const to = parseManifestURL(imports[key], url);
+          if (from !== undefined && to !== undefined) {
+            manifest.set(from, to);
+          }
+        });
+      })
+      .finally(() => {
+        if (manifestLoading === loading) {
+          manifestLoading = undefined;
+        }
+      });
+    manifestLoading = loading;
+    return loading;
+  };
+
+  // Writes everything resolved so far to a manifest at `url`.
+  namespace.writeManifest = (url) => {
+    const imports = {};
+    [...resolved.keys()].sort().forEach((key) => {
+      imports[key] = resolved.get(key);
+    });
+    return fileSystem.writeFile(url, `${JSON.stringify({ imports }, null, 2)}\n`);
+  };
+
+  // Makes flushManifest() write to `url`.
+  namespace.recordManifest = (url) => {
+    manifestOutput = url;
+  };
+
+  // Called after a module graph has been evaluated. Rewrites the manifest
+  // given to recordManifest() if anything new was resolved.
+  namespace.flushManifest = () => {
+    if (manifestOutput === undefined || !manifestDirty) {
+      return undefined;
+    }
+    manifestDirty = false;
+    return namespace.writeManifest(manifestOutput);
+  };
+
+  // Forgets the listings of `url` and of its parent directory and every
+  // resolution that depended on them.
+  namespace.invalidate = (url) => {
+    let path = typeof url === 'string' && !/^file:/.test(url) ? url : getFilePathFromURL(url);
+    if (path.length > 1 && path.endsWith('/')) {
+      path = path.slice(0, -1);
+    }
+    stats.invalidations += 1;
+    [path, split(path)[0]].forEach((dir) => {
+      [manifest, resolved].forEach((map) => map.forEach((file, key) => {
+        if (split(getFilePathFromURL(key))[0] === dir) {
+          map.delete(key);
+        }
+      }));
+      listings.delete(dir);
+      const keys = dependents.get(dir);
+      if (keys !== undefined) {
+        keys.forEach((key) => resolutions.delete(key));
+        dependents.delete(dir);
+      }
+    });
+  };
+
+  namespace.getStats = () => ({
+    ...stats,
+    entries: resolutions.size,
+    manifestEntries: manifest.size,
+  });
+};
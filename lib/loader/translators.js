@@ -2,27 +2,27 @@
 
 ({ namespace, binding, load, process }) => {
   const { ModuleWrap } = binding('module_wrap');
-  const { fileSystem } = load('file_system');
+  const { compileModule } = load('loader/compile_cache');
   const { createDynamicModule } = load('loader/create_dynamic_module');
   const { parseDataURL } = load('whatwg/url');
 
   const translators = namespace.translators = new Map();
 
-  const translateModule = async (specifier) => {
-    const source = do {
-      if (specifier === '[eval]') {
-        process.options.eval;
-      } else if (/^data:/.test(specifier)) {
-        parseDataURL(specifier).body;
-      } else {
-        await fileSystem.readFile(specifier, { encoding: 'utf8' });
-      }
-    };
-    return new ModuleWrap(source, specifier);
+  const translateModule = async (specifier, loader) => {
+    if (specifier === '[eval]') {
+      return new ModuleWrap(process.options.eval, specifier);
+    }
+    if (/^data:/.test(specifier)) {
+      return new ModuleWrap(parseDataURL(specifier).body, specifier);
+    }
+    const source = await loader.readSource(specifier);
+    return compileModule(specifier, source);
   };
 
   translators.set('esm', translateModule);
 
+  translators.set('bundle', async (specifier, loader) =>
+    loader.findBundle(specifier).compile(specifier));
 
   translators.set('builtin', async (specifier) => {
     const id = specifier.slice(6); // slice "@zero/"
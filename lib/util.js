@@ -85,6 +85,34 @@
 
   namespace.defineIDLClass = defineIDLClass;
 
+  // Defines each property in `getters` as an accessor that computes the value
+  // on first access and then replaces itself with a plain data property, so
+  // that builtins behind rarely used globals are only loaded when needed.
+  namespace.defineLazyProperties = (target, getters, enumerable = false) => {
+    Object.keys(getters).forEach((key) => {
+      const define = (value) => {
+        Object.defineProperty(target, key, {
+          value,
+          writable: true,
+          enumerable,
+          configurable: true,
+        });
+      };
+      Object.defineProperty(target, key, {
+        get() {
+          const value = getters[key]();
+          define(value);
+          return value;
+        },
+        set(value) {
+          define(value);
+        },
+        enumerable,
+        configurable: true,
+      });
+    });
+  };
+
   namespace.CreatePromise = () => new Promise(() => undefined);
   const {
     MarkPromiseAsHandled,
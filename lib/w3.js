@@ -1,21 +1,14 @@
 'use strict';
 
 ({ namespace, load }) => {
-  const { Performance } = load('w3/performance');
-  const { Crypto } = load('w3/crypto');
-  const { Blob } = load('w3/blob');
+  const { defineLazyProperties } = load('util');
 
-  Object.defineProperties(global, {
-    Blob: {
-      value: Blob,
-      writable: true,
-      configurable: true,
-      enumerable: false,
-    },
+  defineLazyProperties(global, {
+    Blob: () => load('w3/blob').Blob,
   });
 
-  const globalProto = Object.getPrototypeOf(global);
-
-  namespace.crypto = globalProto.crypto = new Crypto();
-  namespace.performance = globalProto.performance = new Performance();
+  defineLazyProperties(Object.getPrototypeOf(global), {
+    crypto: () => new (load('w3/crypto').Crypto)(),
+    performance: () => new (load('w3/performance').Performance)(),
+  });
 };
@@ -3,7 +3,7 @@
 ({ namespace, binding, load, PrivateSymbol: PS }) => {
   const {
     now,
-    timeOrigin,
+    timeOrigin: getTimeOrigin,
   } = binding('performance');
   const { defineIDLClass } = load('util');
 
@@ -56,7 +56,9 @@
 
   defineIDLClass(Performance, undefined, {
     now,
-    timeOrigin,
+    get timeOrigin() {
+      return getTimeOrigin();
+    },
     timing: new PerformanceTiming(),
     mark(name) {
       name = `${name}`;
@@ -73,7 +75,7 @@
         throw new Error('Invalid performance mark');
       }
 
-      let startTimestamp = timeOrigin;
+      let startTimestamp = getTimeOrigin();
       const start = marks.get(startMark);
       if (start && start[kStartTime] !== 0) {
         startTimestamp = start[kStartTime];
@@ -1,20 +1,10 @@
 'use strict';
 
-({ load, process, namespace }) => {
+({ load, binding, process, namespace }) => {
+  const { enqueueMicrotask } = binding('util');
+  const { defineLazyProperties } = load('util');
   const { setTimeout, clearTimeout, setInterval, clearInterval } = load('whatwg/timers');
   const { EventTarget, Event, CustomEvent } = load('whatwg/events');
-  const { ReadableStream } = load('whatwg/streams/readable');
-  const { WritableStream } = load('whatwg/streams/writable');
-  const { TransformStream } = load('whatwg/streams/transform');
-  const {
-    ByteLengthQueuingStrategy,
-    CountQueuingStrategy,
-  } = load('whatwg/streams/queuing_strategy');
-  const { Console } = load('whatwg/console');
-  const { TextEncoder, TextDecoder } = load('whatwg/encoding');
-  const { URL, URLSearchParams } = load('whatwg/url');
-  const { Headers, FormData } = load('whatwg/fetch');
-  const { WebSocket } = load('whatwg/websocket');
 
   const attach = (name, value, enumerable = false) => {
     Object.defineProperty(global, name, {
@@ -25,8 +15,6 @@
     });
   };
 
-  const console = new Console(process.stdout, process.stderr);
-
   attach('setTimeout', setTimeout, true);
   attach('clearTimeout', clearTimeout, true);
   attach('setInterval', setInterval, true);
@@ -36,31 +24,32 @@
   attach('Event', Event);
   attach('CustomEvent', CustomEvent);
 
-  attach('ReadableStream', ReadableStream);
-  attach('WritableStream', WritableStream);
-  attach('TransformStream', TransformStream);
-  attach('ByteLengthQueuingStrategy', ByteLengthQueuingStrategy);
-  attach('CountQueuingStrategy', CountQueuingStrategy);
-
-  attach('console', console);
+  defineLazyProperties(global, {
+    ReadableStream: () => load('whatwg/streams/readable').ReadableStream,
+    WritableStream: () => load('whatwg/streams/writable').WritableStream,
+    TransformStream: () => load('whatwg/streams/transform').TransformStream,
+    ByteLengthQueuingStrategy: () =>
+      load('whatwg/streams/queuing_strategy').ByteLengthQueuingStrategy,
+    CountQueuingStrategy: () => load('whatwg/streams/queuing_strategy').CountQueuingStrategy,
 
-  attach('TextEncoder', TextEncoder);
-  attach('TextDecoder', TextDecoder);
+    TextEncoder: () => load('whatwg/encoding').TextEncoder,
+    TextDecoder: () => load('whatwg/encoding').TextDecoder,
 
-  attach('URL', URL);
-  attach('URLSearchParams', URLSearchParams);
-  attach('FormData', FormData);
-  attach('Headers', Headers);
+    URL: () => load('whatwg/url').URL,
+    URLSearchParams: () => load('whatwg/url').URLSearchParams,
+    FormData: () => load('whatwg/fetch').FormData,
+    Headers: () => load('whatwg/fetch').Headers,
 
-  attach('WebSocket', WebSocket);
+    WebSocket: () => load('whatwg/websocket').WebSocket,
+  });
 
   attach('queueMicrotask', (callback) => {
     enqueueMicrotask(() => {
       try {
         callback();
       } catch (e) {
-        const e = new ErrorEvent();
-        EventTarget.prototype.dispatchEvent.call(global, e);
+        const event = new Event('error');
+        EventTarget.prototype.dispatchEvent.call(global, event);
       }
     });
   });
@@ -68,5 +57,19 @@
   Object.assign(Object.getPrototypeOf(global), EventTarget.prototype);
   EventTarget.call(global);
 
-  namespace.console = console;
+  // process.stdout and process.stderr don't exist until the process starts,
+  // so the console can't be part of the startup snapshot. It is created on
+  // first use, by user code or by zero itself through the returned getter.
+  namespace.attachConsole = () => {
+    let console;
+    const getConsole = () => {
+      if (console === undefined) {
+        const { Console } = load('whatwg/console');
+        console = new Console(process.stdout, process.stderr);
+      }
+      return console;
+    };
+    defineLazyProperties(global, { console: getConsole });
+    return getConsole;
+  };
 };
@@ -1,6 +1,6 @@
 'use strict';
 
-({ load, namespace, PrivateSymbol, binding, process }) => {
+({ load, namespace, PrivateSymbol, binding }) => {
   const { format } = load('util');
   const performance = load('w3/performance');
   const { table: cliTable } = load('util/cli_table');
@@ -34,8 +34,6 @@
 
   const isArray = (v) => Array.isArray(v) || isTypedArray(v);
 
-  const color = !!process.stdout.isTTY;
-
   class Console {
     constructor(stdout, stderr) {
       this[kStdout] = stdout;
@@ -46,6 +44,8 @@
 
       this[kGroupIndent] = 0;
 
+      const color = !!stdout.isTTY;
+
       this[kPrint] = (level, args) => {
         let message = format({ color }, ...args);
 
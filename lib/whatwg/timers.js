@@ -5,23 +5,24 @@
 ({ namespace, binding, load }) => {
   const { TimerWrap } = binding('timer_wrap');
   const ScriptWrap = binding('script_wrap');
-  const { performance } = load('w3');
 
-  const queue = [];
+  // Pending timers by id. Their expiry and order live in the native
+  // TimerWrap heap; this only holds what is needed to run them.
+  const timers = new Map();
 
   let nestingLevel = 0;
 
-  const wrap = new TimerWrap(() => {
-    const now = performance.now();
-    queue.forEach((item, index) => {
-      if (item.expiry > now) {
+  // Called once per loop turn with the ids of all due timers, in expiry order.
+  const onTimeout = (ids) => {
+    ids.forEach((id) => {
+      const item = timers.get(id);
+      if (item === undefined) {
+        // cleared by a timer that ran earlier in this turn
         return;
       }
 
-      queue.splice(index, 1);
-
-      if (item.repeat) {
-        insert(item); // eslint-disable-line no-use-before-define
+      if (!item.repeat) {
+        timers.delete(id);
       }
 
       const lastNestingLevel = nestingLevel;
@@ -37,34 +38,17 @@
 
       nestingLevel = lastNestingLevel;
     });
+  };
 
-    if (queue.length > 0) {
-      const next = queue[0];
-      wrap.update(Math.max(next.expiry - performance.now(), 1));
-    }
-  });
-
+  // The native handle is created on first use so it never ends up in the
+  // startup snapshot.
+  let wrap;
   const insert = (item) => {
-    const msecs = item.timeout;
-    if (msecs < 0 || msecs === undefined) {
-      return;
-    }
-
-    item.expiry = item.expiry ?
-      item.expiry + msecs :
-      performance.now() + msecs;
-
-    if (queue.length > 0) {
-      const next = queue[0];
-      if (next.expiry > item.expiry) {
-        wrap.update(msecs);
-      }
-      queue.push(item);
-      queue.sort((a, b) => a.expiry - b.expiry || a.id - b.id);
-    } else {
-      queue.push(item);
-      wrap.update(msecs);
+    if (wrap === undefined) {
+      wrap = new TimerWrap(onTimeout);
     }
+    timers.set(item.id, item);
+    wrap.schedule(item.id, item.timeout, item.repeat);
   };
 
   const TIMEOUT_MAX = (2 ** 31) - 1;
@@ -76,8 +60,6 @@
 
       this.nestingLevel = nestingLevel + 1;
 
-      this.expiry = undefined;
-
       this.repeat = repeat;
 
       this.id = timerId;
@@ -107,11 +89,10 @@
   };
 
   namespace.clearTimeout = namespace.clearInterval = (handle) => {
-    const index = queue.findIndex((item) => item.id === handle);
-    if (index !== -1) {
-      queue.splice(index, 1);
-      return true;
+    if (!timers.delete(handle)) {
+      return false;
     }
-    return false;
+    wrap.cancel(handle);
+    return true;
   };
 };
@@ -9,83 +9,6 @@
   process.versions.zero = '0.0.1';
   Object.freeze(process.versions);
 
-  const ZERO_HELP = `
-  zero [OPTIONS] <entry>
-
-  -h, --help      show list of command line options
-  -v, --version   show version of zero
-  -e, --eval      evaluate module source from the current working directory
-  -m, --mode      Set parse mode of the entry point. Defaults to "module"
-`;
-
-  const options = {
-    mode: 'module',
-    eval: undefined,
-    entry: undefined,
-  };
-
-  {
-    const handle = (name, value) => {
-      if (name === 'v' || name === 'version') {
-        debug.log(process.versions.zero);
-        process.exit(0);
-        return;
-      }
-
-      if (name === 'h' || name === 'help') {
-        debug.log(ZERO_HELP);
-        process.exit(0);
-        return;
-      }
-
-      if (name === 'e' || name === 'eval') {
-        options.eval = value;
-        return;
-      }
-
-      if (name === 'm' || name === 'mode') {
-        options.mode = value;
-        return;
-      }
-
-      throw new RangeError(`Invalid argument: ${name}`);
-    };
-
-    let pastOptions = false;
-    const userArgv = [];
-
-    process.argv0 = process.argv.shift();
-
-    for (let i = 0; i < process.argv.length; i += 1) {
-      const arg = process.argv[i];
-
-      if (pastOptions) {
-        userArgv.push(arg);
-      } else if (arg === '--') {
-        pastOptions = true;
-      } else if (/^-[^-]/.test(arg)) {
-        if (arg.length === 2) {
-          i += 1;
-          handle(arg.slice(1), process.argv[i]);
-        } else {
-          arg.slice(1).split('').map((a) => handle(a, true));
-        }
-      } else if (/^--(.+?)=/.test(arg)) {
-        const [name, value] = arg.slice(2).split(/=(.+)/);
-        handle(name, value);
-      } else if (/^--/.test(arg)) {
-        i += 1;
-        handle(arg.slice(2), process.argv[i]);
-      } else {
-        options.entry = arg;
-        userArgv.push(arg);
-        pastOptions = true;
-      }
-    }
-
-    process.argv = userArgv;
-  }
-
   Object.defineProperties(this, {
     global: {
       value: this,
@@ -93,32 +16,6 @@
       enumerable: false,
       configurable: true,
     },
-    environment: {
-      value: new (class Environment {
-        argv = process.argv;
-
-        argv0 = process.argv0;
-
-        getEnv(name) {
-          name = `${name}`;
-          return utilBinding.getEnv(name);
-        }
-
-        setEnv(name, value) {
-          name = `${name}`;
-          value = `${value}`;
-          return utilBinding.setEnv(name, value);
-        }
-
-        deleteEnv(name) {
-          name = `${name}`;
-          return utilBinding.unsetEnv(name);
-        }
-      })(),
-      enumerable: false,
-      writable: false,
-      configurable: false,
-    },
   });
 
   const ScriptWrap = binding('script_wrap');
@@ -179,24 +76,18 @@
   load.cache = {};
 
   load('errors');
-  load('ffi'); // attaches to global
 
-  Object.defineProperties(global, {
-    MIME: {
-      value: load('mime').MIME,
-      enumerable: false,
-      configurable: true,
-      writable: true,
-    },
+  const { defineLazyProperties } = load('util');
+
+  defineLazyProperties(global, {
+    MIME: () => load('mime').MIME,
+    fileSystem: () => load('file_system').fileSystem,
   });
 
   const { TTYWrap } = load('tty');
 
-  process.stdout = new TTYWrap(1);
-  process.stderr = new TTYWrap(2);
-
   load('w3'); // attaches globals
-  const { console } = load('whatwg'); // attaches globals
+  const { attachConsole } = load('whatwg'); // attaches globals
 
   const { Event, dispatchEvent } = global;
 
@@ -235,70 +126,292 @@
     dispatchEvent(e);
   };
 
-  setCallbacks(onExit, promiseCallback);
-
-  const { fileSystem } = load('file_system');
-  global.fileSystem = fileSystem;
-
   const { getURLFromFilePath, URL } = load('whatwg/url');
   const { Loader, attachLoaderGlobals } = load('loader');
+  const compileCache = load('loader/compile_cache');
+  const resolutionCache = load('loader/resolution_cache');
+  const { createBundle } = load('loader/bundle');
 
-  if (!config.allowNativesSyntax) {
-    setV8Flags('--no_allow_natives_syntax');
-  }
+  const ZERO_HELP = `
+  zero [OPTIONS] <entry>
+  zero [OPTIONS] --bundle <file>
 
-  if (config.exposeBinding === true) {
-    global.binding = binding;
-  }
+  -h, --help      show list of command line options
+  -v, --version   show version of zero
+  -e, --eval      evaluate module source from the current working directory
+  -m, --mode      Set parse mode of the entry point. Defaults to "module"
+  --compile-cache Directory to cache compiled code in. Defaults to the
+                  ZERO_COMPILE_CACHE environment variable
+  --manifest      Resolution manifest to resolve imports from instead of the
+                  file system, as written by --write-manifest
+  --write-manifest
+                  File to record every import resolved during the run in
+  --bundle        Run the application in a bundle file
+  --create-bundle Write the entry and every module it imports to a bundle
+                  file instead of running it
+  --fs-backend=<threadpool|io_uring>
+                  How file system requests are run. io_uring falls back to the
+                  threadpool when the kernel doesn't support it. Defaults to
+                  the ZERO_FS_BACKEND environment variable, or threadpool
+  --v8-pool-size=<n>
+                  Number of V8 background threads. Defaults to one less than
+                  the number of CPUs
+`;
 
-  const cwdURL = `${getURLFromFilePath(process.cwd)}/`;
+  // Everything above this point is captured in the startup snapshot (see
+  // BuildSnapshot in src/zero.cc). Anything that depends on the running
+  // process (argv, cwd, stdio handles, native callbacks) belongs in start().
+  const start = (argv, cwd) => {
+    process.argv = argv;
+    process.cwd = cwd;
+
+    setCallbacks(onExit, promiseCallback);
+
+    const options = {
+      mode: 'module',
+      eval: undefined,
+      entry: undefined,
+      manifest: undefined,
+      writeManifest: undefined,
+      bundle: undefined,
+      createBundle: undefined,
+      compileCache: utilBinding.getEnv('ZERO_COMPILE_CACHE'),
+    };
+
+    {
+      const handle = (name, value) => {
+        if (name === 'v' || name === 'version') {
+          debug.log(process.versions.zero);
+          process.exit(0);
+          return;
+        }
+
+        if (name === 'h' || name === 'help') {
+          debug.log(ZERO_HELP);
+          process.exit(0);
+          return;
+        }
+
+        if (name === 'e' || name === 'eval') {
+          options.eval = value;
+          return;
+        }
+
+        if (name === 'm' || name === 'mode') {
+          options.mode = value;
+          return;
+        }
+
+        if (name === 'compile-cache') {
+          options.compileCache = value;
+          return;
+        }
+
+        if (name === 'manifest') {
+          options.manifest = value;
+          return;
+        }
+
+        if (name === 'write-manifest') {
+          options.writeManifest = value;
+          return;
+        }
 
-  const loader = new Loader(cwdURL);
-  attachLoaderGlobals(loader);
+        if (name === 'bundle') {
+          options.bundle = value;
+          return;
+        }
+
+        if (name === 'create-bundle') {
+          options.createBundle = value;
+          return;
+        }
+
+        throw new RangeError(`Invalid argument: ${name}`);
+      };
+
+      let pastOptions = false;
+      const userArgv = [];
+
+      process.argv0 = process.argv.shift();
+
+      for (let i = 0; i < process.argv.length; i += 1) {
+        const arg = process.argv[i];
+
+        if (pastOptions) {
+          userArgv.push(arg);
+        } else if (arg === '--') {
+          pastOptions = true;
+        } else if (/^-[^-]/.test(arg)) {
+          if (arg.length === 2) {
+            i += 1;
+            handle(arg.slice(1), process.argv[i]);
+          } else {
+            arg.slice(1).split('').map((a) => handle(a, true));
+          }
+        } else if (/^--(.+?)=/.test(arg)) {
+          const [name, value] = arg.slice(2).split(/=(.+)/);
+          handle(name, value);
+        } else if (/^--/.test(arg)) {
+          i += 1;
+          handle(arg.slice(2), process.argv[i]);
+        } else {
+          options.entry = arg;
+          userArgv.push(arg);
+          pastOptions = true;
+        }
+      }
 
-  const onError = (e) => {
-    try {
-      console.error(e);
-    } catch (err) {
-      process.stdout.write(`${e}\n`);
-    } finally {
-      process.exit(1);
+      process.argv = userArgv;
     }
-  };
 
-  process.options = options;
+    Object.defineProperties(global, {
+      environment: {
+        value: new (class Environment {
+          argv = process.argv;
+
+          argv0 = process.argv0;
+
+          getEnv(name) {
+            name = `${name}`;
+            return utilBinding.getEnv(name);
+          }
+
+          setEnv(name, value) {
+            name = `${name}`;
+            value = `${value}`;
+            return utilBinding.setEnv(name, value);
+          }
+
+          deleteEnv(name) {
+            name = `${name}`;
+            return utilBinding.unsetEnv(name);
+          }
+
+          get compileCacheStats() {
+            return compileCache.getStats();
+          }
+
+          get resolutionStats() {
+            return resolutionCache.getStats();
+          }
+
+          // Makes later imports look at the directory `url`, or the
+          // directory containing it, again.
+          invalidateResolution(url) {
+            resolutionCache.invalidate(url);
+          }
+
+          // Adds the entries of the resolution manifest at `url`.
+          loadResolutionManifest(url) {
+            return resolutionCache.loadManifest(new URL(url, cwdURL));
+          }
+
+          // Writes every import resolved so far to a manifest at `url`.
+          writeResolutionManifest(url) {
+            return resolutionCache.writeManifest(new URL(url, cwdURL));
+          }
+
+          // Writes the module at `entry` and everything it statically
+          // imports to a bundle file at `output`.
+          createBundle(entry, output) {
+            return createBundle(loader, `${entry}`, output);
+          }
+
+          // Imports the entry point of the bundle file at `url`.
+          importBundle(url) {
+            return loader.importBundle(new URL(url, cwdURL));
+          }
+        })(),
+        enumerable: false,
+        writable: false,
+        configurable: false,
+      },
+    });
+
+    process.stdout = new TTYWrap(1);
+    process.stderr = new TTYWrap(2);
 
-  if (options.eval) {
-    if (options.mode === 'module') {
-      loader.getModuleJob('[eval]')
-        .then((job) => job.run())
-        .then(({ result }) => console.log(result))
-        .catch(onError);
-    } else if (options.mode === 'script') {
+    const getConsole = attachConsole();
+
+    defineLazyProperties(global, {
+      DynamicLibrary: () => load('ffi').DynamicLibrary,
+    });
+
+    if (!config.allowNativesSyntax) {
+      setV8Flags('--no_allow_natives_syntax');
+    }
+
+    if (config.exposeBinding === true) {
+      global.binding = binding;
+    }
+
+    if (options.compileCache) {
+      compileCache.configure(options.compileCache);
+    }
+
+    const cwdURL = `${getURLFromFilePath(process.cwd)}/`;
+
+    const loader = new Loader(cwdURL);
+    attachLoaderGlobals(loader);
+
+    const onError = (e) => {
       try {
-        console.log(ScriptWrap.run('[eval]', options.eval));
+        getConsole().error(e);
       } catch (err) {
-        onError(err);
+        process.stdout.write(`${e}\n`);
+      } finally {
+        process.exit(1);
       }
-    } else {
-      throw new RangeError('invalid mode');
+    };
+
+    process.options = options;
+
+    if (options.manifest) {
+      resolutionCache.loadManifest(new URL(options.manifest, cwdURL)).catch(onError);
+    }
+    if (options.writeManifest) {
+      resolutionCache.recordManifest(new URL(options.writeManifest, cwdURL));
     }
-  } else if (options.entry) {
-    if (options.mode === 'module') {
-      loader.import(options.entry).catch(onError);
-    } else if (options.mode === 'script') {
-      const url = new URL(options.entry, cwdURL);
-      fileSystem.readFile(url, { encoding: 'utf8' })
-        .then((src) => ScriptWrap.run(url, src))
+
+    if (options.createBundle) {
+      if (!options.entry) {
+        throw new RangeError('--create-bundle needs an entry');
+      }
+      createBundle(loader, options.entry, new URL(options.createBundle, cwdURL))
         .catch(onError);
+    } else if (options.bundle) {
+      loader.importBundle(new URL(options.bundle, cwdURL)).catch(onError);
+    } else if (options.eval) {
+      if (options.mode === 'module') {
+        loader.runJob('[eval]')
+          .then(({ result }) => getConsole().log(result))
+          .catch(onError);
+      } else if (options.mode === 'script') {
+        try {
+          getConsole().log(ScriptWrap.run('[eval]', options.eval));
+        } catch (err) {
+          onError(err);
+        }
+      } else {
+        throw new RangeError('invalid mode');
+      }
+    } else if (options.entry) {
+      if (options.mode === 'module') {
+        loader.import(options.entry).catch(onError);
+      } else if (options.mode === 'script') {
+        compileCache.runScriptFile(new URL(options.entry, cwdURL)).catch(onError);
+      } else {
+        throw new RangeError('invalid mode');
+      }
     } else {
-      throw new RangeError('invalid mode');
-    }
-  } else {
-    try {
-      load('repl').start();
-    } catch (err) {
-      onError(err);
+      try {
+        load('repl').start();
+      } catch (err) {
+        onError(err);
+      }
     }
-  }
+  };
+
+  return start;
 };
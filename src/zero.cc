@@ -4,17 +4,24 @@
 #include <string.h>
 #include <limits.h>  // PATH_MAX
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "v8.h"
 #include "zero.h"
 #include "zero_script_wrap.h"
 #include "zero_blobs.h"
 #include "zero_errors.h"
 #include "zero_platform.h"
+#include "zero_snapshot.h"
+#include "zero_uring.h"
 
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::Boolean;
 using v8::Context;
+using v8::EscapableHandleScope;
 using v8::HandleScope;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -24,6 +31,7 @@ using v8::MaybeLocal;
 using v8::Name;
 using v8::Number;
 using v8::Isolate;
+using v8::JSON;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
@@ -33,7 +41,12 @@ using v8::Persistent;
 using v8::Platform;
 using v8::Promise;
 using v8::PropertyCallbackInfo;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::SnapshotCreator;
+using v8::StartupData;
 using v8::TryCatch;
+using v8::UnboundScript;
 
 #define ZERO_INTERNAL_MODULES(V) \
   V(encoding);                   \
@@ -41,9 +54,12 @@ using v8::TryCatch;
   V(module_wrap);                \
   V(script_wrap);                \
   V(fs);                         \
+  V(walk);                       \
+  V(mmap);                       \
   V(tty);                        \
   V(debug);                      \
   V(performance);                \
+  V(platform);                   \
   V(tcp_wrap);                   \
   V(inspector_sync);             \
   V(types);                      \
@@ -55,6 +71,12 @@ using v8::TryCatch;
 ZERO_INTERNAL_MODULES(V)
 #undef V
 
+#define V(name)                                                               \
+  void _zero_register_external_references_##name(                            \
+      zero::ExternalReferenceRegistry* registry)
+ZERO_INTERNAL_MODULES(V)
+#undef V
+
 namespace zero {
 
 static zero_module* modlist;
@@ -104,10 +126,16 @@ static void Init(Local<Context> context, Local<Object> exports) {
   ZERO_SET_PROPERTY(context, exports, "error", DebugError);
 }
 
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(DebugLog);
+  registry->Register(DebugError);
+}
+
 }  // namespace js_debug
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(debug, zero::js_debug::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(debug, zero::js_debug::RegisterExternalReferences);
 
 static void Bindings(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
@@ -177,6 +205,267 @@ static void SetCallbacks(const FunctionCallbackInfo<Value>& args) {
   isolate->SetPromiseRejectCallback(PromiseRejectCallback);
 }
 
+static void RegisterExternalReferences(zero::ExternalReferenceRegistry* registry) {
+  registry->Register(Bindings);
+  registry->Register(SetCallbacks);
+  registry->Register(Exit);
+
+#define V(name) _zero_register_external_references_##name(registry)
+  ZERO_INTERNAL_MODULES(V)
+#undef V
+}
+
+// Runs lib/zero.js, which loads all of the builtins and returns the function
+// that starts the process. When zero is built with a startup snapshot this
+// only happens once, at build time.
+static MaybeLocal<Function> Bootstrap(Isolate* isolate, Local<Context> context) {
+  EscapableHandleScope scope(isolate);
+
+  context->SetEmbedderData(zero::EmbedderKeys::kBindingCache, Object::New(isolate));
+
+  Local<Object> process = Object::New(isolate);
+
+  Local<Object> versions = Object::New(isolate);
+
+  ZERO_SET_PROPERTY(context, process, "versions", versions);
+  ZERO_SET_PROPERTY(context, versions, "v8", V8::GetVersion());
+  ZERO_SET_PROPERTY(context, versions, "uv", uv_version_string());
+
+  ZERO_SET_PROPERTY(context, process, "exit", Exit);
+  ZERO_SET_PROPERTY(context, process, "isLittleEndian", zero::IsLittleEndian());
+
+  int argc = 3;
+  Local<Value> args[] = {
+    process,
+    FunctionTemplate::New(isolate, Bindings)->GetFunction(),
+    FunctionTemplate::New(isolate, SetCallbacks)->GetFunction(),
+  };
+
+  Local<Value> zero_fn;
+  if (!zero::ScriptWrap::Run(isolate, ZERO_STRING(isolate, "zero"),
+                             zero::blobs::MainSource(isolate)).ToLocal(&zero_fn))
+    return MaybeLocal<Function>();
+
+  Local<Value> start;
+  if (!zero_fn.As<Function>()->Call(
+        context, context->Global(), argc, args).ToLocal(&start))
+    return MaybeLocal<Function>();
+
+  CHECK(start->IsFunction());
+  return scope.Escape(start.As<Function>());
+}
+
+static void WriteByteArray(FILE* fp, const char* name, const uint8_t* data, int length) {
+  fprintf(fp, "static const unsigned char %s[] = {\n", name);
+  for (int i = 0; i < length; i += 1) {
+    fprintf(fp, "%u,", data[i]);
+    if (i % 32 == 31)
+      fprintf(fp, "\n");
+  }
+  fprintf(fp, "\n};\n\n");
+}
+
+static int WriteSnapshot(const char* filename, const StartupData& blob) {
+  FILE* fp = fopen(filename, "w");
+  if (fp == nullptr) {
+    perror(filename);
+    return 1;
+  }
+
+  fprintf(fp, "#include \"../src/zero_snapshot.h\"\n\n");
+  fprintf(fp, "namespace zero {\nnamespace snapshot {\n\n");
+  WriteByteArray(fp, "blob_data",
+                 reinterpret_cast<const uint8_t*>(blob.data), blob.raw_size);
+  fprintf(fp, "static v8::StartupData blob = {\n"
+              "  reinterpret_cast<const char*>(blob_data),\n"
+              "  %d,\n"
+              "};\n\n", blob.raw_size);
+  fprintf(fp, "v8::StartupData* GetStartupData() {\n  return &blob;\n}\n\n");
+  fprintf(fp, "}  // namespace snapshot\n}  // namespace zero\n");
+
+  return fclose(fp) == 0 ? 0 : 1;
+}
+
+// Bootstraps a fresh context and serializes it, along with the start function
+// returned by lib/zero.js, into a C++ source file that is linked into out/zero.
+static int BuildSnapshot(const char* filename) {
+  zero::ExternalReferenceRegistry registry;
+  RegisterExternalReferences(&registry);
+
+  SnapshotCreator creator(registry.external_references());
+  Isolate* isolate = creator.GetIsolate();
+
+  zero::platform->RegisterIsolate(isolate, uv_default_loop());
+
+  {
+    HandleScope handle_scope(isolate);
+
+    Local<Context> context = Context::New(isolate);
+    Context::Scope context_scope(context);
+
+    context->SetAlignedPointerInEmbedderData(zero::EmbedderKeys::kInspector, nullptr);
+
+    TryCatch try_catch(isolate);
+
+    Local<Function> start;
+    if (!Bootstrap(isolate, context).ToLocal(&start)) {
+      zero::errors::ReportException(isolate, &try_catch);
+      return 1;
+    }
+
+    zero::InternalCallbackScope::Run(isolate);
+
+    size_t index = creator.AddData(context, start);
+    CHECK_EQ(index, zero::snapshot::kStartFunction);
+
+    creator.SetDefaultContext(context);
+  }
+
+  zero::platform->UnregisterIsolate(isolate);
+  uv_run(uv_default_loop(), UV_RUN_NOWAIT);
+
+  StartupData blob =
+      creator.CreateBlob(SnapshotCreator::FunctionCodeHandling::kKeep);
+  if (blob.data == nullptr) {
+    fprintf(stderr, "failed to create snapshot\n");
+    return 1;
+  }
+
+  int err = WriteSnapshot(filename, blob);
+  delete[] blob.data;
+  return err;
+}
+
+// Compiles lib/zero.js and every builtin in a fresh isolate and writes their
+// code caches into a C++ source file that is linked into out/zero, where
+// ScriptWrap::Run consumes them instead of compiling from scratch.
+static int BuildCodeCache(const char* filename) {
+  FILE* fp = fopen(filename, "w");
+  if (fp == nullptr) {
+    perror(filename);
+    return 1;
+  }
+
+  fprintf(fp, "#include <cstring>\n\n");
+  fprintf(fp, "#include \"../src/zero_code_cache.h\"\n\n");
+  fprintf(fp, "namespace zero {\nnamespace code_cache {\n\n");
+
+  Isolate::CreateParams create_params;
+  create_params.array_buffer_allocator =
+      ArrayBuffer::Allocator::NewDefaultAllocator();
+  Isolate* isolate = Isolate::New(create_params);
+
+  std::vector<std::string> specifiers;
+
+  {
+    Isolate::Scope isolate_scope(isolate);
+    HandleScope handle_scope(isolate);
+
+    Local<Context> context = Context::New(isolate);
+    Context::Scope context_scope(context);
+
+    Local<Object> natives = Object::New(isolate);
+    zero::blobs::DefineJavaScript(isolate, natives);
+    ZERO_SET_PROPERTY(context, natives, "zero", zero::blobs::MainSource(isolate));
+
+    // A cache is only accepted under the V8 flags it was made with, and
+    // start() turns off --allow-natives-syntax unless zero was configured
+    // with it. Builtins are therefore cached under the flags start() leaves
+    // behind, except for those that use native syntax, which can only be
+    // loaded before start() runs.
+    Local<Value> config = JSON::Parse(
+        context,
+        natives->Get(context, ZERO_STRING(isolate, "out/config"))
+            .ToLocalChecked().As<String>()).ToLocalChecked();
+    bool allow_natives_syntax = config.As<Object>()
+        ->Get(context, ZERO_STRING(isolate, "allowNativesSyntax"))
+        .ToLocalChecked()->IsTrue();
+    if (!allow_natives_syntax) {
+      V8::SetFlagsFromString("--no-allow-natives-syntax",
+                             strlen("--no-allow-natives-syntax"));
+    }
+
+    auto compile = [&](Local<String> key, bool report) {
+      String::Utf8Value specifier(isolate, key);
+
+      ScriptOrigin origin(key);
+      ScriptCompiler::Source source(
+          natives->Get(context, key).ToLocalChecked().As<String>(), origin);
+
+      TryCatch try_catch(isolate);
+      Local<UnboundScript> script;
+      if (!ScriptCompiler::CompileUnboundScript(
+            isolate, &source, ScriptCompiler::kNoCompileOptions).ToLocal(&script)) {
+        if (report) {
+          zero::errors::ReportException(isolate, &try_catch);
+        }
+        return false;
+      }
+
+      std::unique_ptr<ScriptCompiler::CachedData> cache(
+          ScriptCompiler::CreateCodeCache(script));
+      std::string name = "cache_" + std::to_string(specifiers.size());
+      WriteByteArray(fp, name.c_str(), cache->data, cache->length);
+      specifiers.push_back(*specifier);
+      return true;
+    };
+
+    std::vector<Local<String>> native_syntax;
+    Local<Array> keys = natives->GetOwnPropertyNames(context).ToLocalChecked();
+    for (uint32_t i = 0; i < keys->Length(); i += 1) {
+      Local<String> key = keys->Get(context, i).ToLocalChecked().As<String>();
+
+      // out/config.json is data, not a script
+      if (strncmp(*String::Utf8Value(isolate, key), "out/", 4) == 0)
+        continue;
+
+      if (!compile(key, allow_natives_syntax)) {
+        if (allow_natives_syntax) {
+          fclose(fp);
+          return 1;
+        }
+        native_syntax.push_back(key);
+      }
+    }
+
+    if (!native_syntax.empty()) {
+      V8::SetFlagsFromString("--allow-natives-syntax",
+                             strlen("--allow-natives-syntax"));
+      for (Local<String> key : native_syntax) {
+        if (!compile(key, true)) {
+          fclose(fp);
+          return 1;
+        }
+      }
+    }
+  }
+
+  isolate->Dispose();
+  delete create_params.array_buffer_allocator;
+
+  fprintf(fp, "static const struct {\n"
+              "  const char* specifier;\n"
+              "  const unsigned char* data;\n"
+              "  int length;\n"
+              "} entries[] = {\n");
+  for (size_t i = 0; i < specifiers.size(); i += 1) {
+    fprintf(fp, "  { \"%s\", cache_%zu, sizeof(cache_%zu) },\n",
+            specifiers[i].c_str(), i, i);
+  }
+  fprintf(fp, "};\n\n");
+  fprintf(fp, "v8::ScriptCompiler::CachedData* Get(const char* specifier) {\n"
+              "  for (const auto& entry : entries) {\n"
+              "    if (strcmp(entry.specifier, specifier) == 0) {\n"
+              "      return new v8::ScriptCompiler::CachedData(entry.data, entry.length);\n"
+              "    }\n"
+              "  }\n"
+              "  return nullptr;\n"
+              "}\n\n");
+  fprintf(fp, "}  // namespace code_cache\n}  // namespace zero\n");
+
+  return fclose(fp) == 0 ? 0 : 1;
+}
+
 static const char* v8_argv[] = {
   "--harmony-class-fields",
   "--harmony-static-fields",
@@ -193,6 +482,20 @@ static int v8_argc = zero::arraysize(v8_argv);
 int main(int process_argc, char** process_argv) {
   process_argv = uv_setup_args(process_argc, process_argv);
 
+  // out/zero_mksnapshot --build-snapshot out/zero_snapshot.cc
+  // out/zero_mksnapshot --build-code-cache out/zero_code_cache.cc
+  const char* snapshot_filename = nullptr;
+  const char* code_cache_filename = nullptr;
+  if (process_argc == 3) {
+    if (strcmp(process_argv[1], "--build-snapshot") == 0) {
+      snapshot_filename = process_argv[2];
+      process_argc = 1;
+    } else if (strcmp(process_argv[1], "--build-code-cache") == 0) {
+      code_cache_filename = process_argv[2];
+      process_argc = 1;
+    }
+  }
+
   char** argv = zero::Malloc<char*>(process_argc + v8_argc);
   argv[0] = process_argv[0];  // grab argv0 which is the process
   int argc = 1;
@@ -201,6 +504,10 @@ int main(int process_argc, char** process_argv) {
   for (int i = 0; i < v8_argc; i += 1) {
     argv[argc++] = const_cast<char*>(v8_argv[i]);
   }
+  int thread_pool_size = zero::ZeroPlatform::DefaultThreadPoolSize();
+
+  const char* fs_backend = getenv("ZERO_FS_BACKEND");
+
   for (int i = 1; i < process_argc; i += 1) {
     char* arg = process_argv[i];
     // V8 can't handle double-dash
@@ -208,10 +515,30 @@ int main(int process_argc, char** process_argv) {
       pick_up_double_dash = i;
       break;
     }
+    if (strncmp(arg, "--fs-backend=", 13) == 0) {
+      fs_backend = arg + 13;
+      if (strcmp(fs_backend, "io_uring") != 0 && strcmp(fs_backend, "threadpool") != 0) {
+        fprintf(stderr, "%s: unknown --fs-backend %s\n", process_argv[0], fs_backend);
+        return 1;
+      }
+      continue;
+    }
+    if (strncmp(arg, "--v8-pool-size=", 15) == 0) {
+      thread_pool_size = atoi(arg + 15);
+      if (thread_pool_size < 1) {
+        fprintf(stderr, "%s: --v8-pool-size must be at least 1\n", process_argv[0]);
+        return 1;
+      }
+      continue;
+    }
     argv[argc++] = arg;
   }
   argv[argc] = 0;
 
+  if (fs_backend != nullptr && strcmp(fs_backend, "io_uring") == 0) {
+    zero::uring::Enable();
+  }
+
   v8::V8::InitializeICU();
 
   V8::SetFlagsFromCommandLine(&argc, const_cast<char**>(argv), true);
@@ -224,13 +551,33 @@ int main(int process_argc, char** process_argv) {
     argv[argc] = 0;
   }
 
-  zero::platform = new zero::ZeroPlatform(4);
+  zero::platform = new zero::ZeroPlatform(thread_pool_size);
   V8::InitializePlatform(zero::platform);
   V8::Initialize();
 
+#define V(name) _zero_register_##name()
+  ZERO_INTERNAL_MODULES(V)
+#undef V
+
+  if (snapshot_filename != nullptr || code_cache_filename != nullptr) {
+    int err = snapshot_filename != nullptr ?
+      BuildSnapshot(snapshot_filename) :
+      BuildCodeCache(code_cache_filename);
+    V8::Dispose();
+    zero::platform->Shutdown();
+    V8::ShutdownPlatform();
+    delete zero::platform;
+    return err;
+  }
+
+  zero::ExternalReferenceRegistry registry;
+  RegisterExternalReferences(&registry);
+
   Isolate::CreateParams create_params;
   create_params.array_buffer_allocator =
       ArrayBuffer::Allocator::NewDefaultAllocator();
+  create_params.snapshot_blob = zero::snapshot::GetStartupData();
+  create_params.external_references = registry.external_references();
   Isolate* isolate = Isolate::New(create_params);
 
   zero::platform->RegisterIsolate(isolate, uv_default_loop());
@@ -238,37 +585,33 @@ int main(int process_argc, char** process_argv) {
   isolate->SetMicrotasksPolicy(v8::MicrotasksPolicy::kExplicit);
   isolate->SetCaptureStackTraceForUncaughtExceptions(true);
 
-#define V(name) _zero_register_##name()
-  ZERO_INTERNAL_MODULES(V)
-#undef V
-
   {
     Isolate::Scope isolate_scope(isolate);
     HandleScope handle_scope(isolate);
 
+    // When a snapshot is present this deserializes the already bootstrapped
+    // context instead of creating an empty one.
     Local<Context> context = Context::New(isolate);
     Context::Scope context_scope(context);
 
-    context->SetEmbedderData(zero::EmbedderKeys::kBindingCache, Object::New(isolate));
     context->SetAlignedPointerInEmbedderData(zero::EmbedderKeys::kInspector, nullptr);
 
-    Local<Object> process = Object::New(isolate);
-
-    Local<Array> pargv = Array::New(isolate, argc);
-    ZERO_SET_PROPERTY(context, process, "argv", pargv);
-    for (int i = 0; i < argc; i++)
-      USE(pargv->Set(context, i, ZERO_STRING(isolate, argv[i])));
-
-    Local<Object> versions = Object::New(isolate);
+    TryCatch try_catch(isolate);
 
-    ZERO_SET_PROPERTY(context, process, "versions", versions);
-    ZERO_SET_PROPERTY(context, versions, "v8", V8::GetVersion());
-    ZERO_SET_PROPERTY(context, versions, "uv", uv_version_string());
+    MaybeLocal<Function> maybe_start;
+    if (create_params.snapshot_blob != nullptr) {
+      maybe_start = context->GetDataFromSnapshotOnce<Function>(
+          zero::snapshot::kStartFunction);
+    } else {
+      maybe_start = Bootstrap(isolate, context);
+    }
 
-    ZERO_SET_PROPERTY(context, process, "exit", Exit);
-    ZERO_SET_PROPERTY(context, process, "isLittleEndian", zero::IsLittleEndian());
+    Local<Function> start;
+    if (maybe_start.ToLocal(&start)) {
+      Local<Array> pargv = Array::New(isolate, argc);
+      for (int i = 0; i < argc; i++)
+        USE(pargv->Set(context, i, ZERO_STRING(isolate, argv[i])));
 
-    {
       char buf[PATH_MAX];
       size_t cwd_len = sizeof(buf);
       int err = uv_cwd(buf, &cwd_len);
@@ -280,26 +623,10 @@ int main(int process_argc, char** process_argv) {
       Local<String> cwd = String::NewFromUtf8(
           isolate, buf, String::kNormalString, cwd_len);
 
-      ZERO_SET_PROPERTY(context, process, "cwd", cwd);
+      Local<Value> args[] = { pargv, cwd };
+      USE(start->Call(context, context->Global(), 2, args));
     }
 
-    int argc = 3;
-    Local<Value> args[] = {
-      process,
-      FunctionTemplate::New(isolate, Bindings)->GetFunction(),
-      FunctionTemplate::New(isolate, SetCallbacks)->GetFunction(),
-    };
-
-    TryCatch try_catch(isolate);
-
-    MaybeLocal<Value> zero_fn_maybe = zero::ScriptWrap::Run(
-        isolate, ZERO_STRING(isolate, "zero"),
-        zero::blobs::MainSource(isolate));
-
-    Local<Value> zero_fn;
-    if (zero_fn_maybe.ToLocal(&zero_fn))
-      USE(zero_fn.As<Function>()->Call(context, context->Global(), argc, args));
-
     uv_loop_t* event_loop = uv_default_loop();
     int more = 1;
     do {
@@ -319,12 +646,19 @@ int main(int process_argc, char** process_argv) {
 
     if (try_catch.HasCaught())
       zero::errors::ReportException(isolate, &try_catch);
+
+    // Foreground tasks can only run while the isolate is entered.
+    zero::platform->DrainTasks(isolate);
   }
 
   zero::platform->UnregisterIsolate(isolate);
+  // Runs the close callbacks of the platform's handles for this isolate.
+  uv_run(uv_default_loop(), UV_RUN_NOWAIT);
   isolate->Dispose();
   V8::Dispose();
+  zero::platform->Shutdown();
   V8::ShutdownPlatform();
+  delete zero::platform;
   delete create_params.array_buffer_allocator;
   uv_tty_reset_mode();
   return 0;
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <unordered_map>
+#include <vector>
 
 #include "v8.h"
 
@@ -132,6 +133,12 @@ inline void ZERO_SET_PROTO_PROP(
     zero_module_register(&_zero_module_##name);                               \
   }
 
+#define ZERO_REGISTER_EXTERNAL_REFERENCES(name, fn)                           \
+  void _zero_register_external_references_##name(                            \
+      zero::ExternalReferenceRegistry* registry) {                            \
+    fn(registry);                                                             \
+  }
+
 namespace zero {
 
 template <typename T, size_t N>
@@ -254,6 +261,31 @@ struct zero_module {
 
 void zero_module_register(void*);
 
+// Every native function that can be reached from the startup snapshot has to
+// be listed here, in the same order, both when the snapshot is created and
+// when it is deserialized. Each internal module registers its callbacks with
+// ZERO_REGISTER_EXTERNAL_REFERENCES.
+class ExternalReferenceRegistry {
+ public:
+  void Register(v8::FunctionCallback callback) {
+    CHECK(!finalized_);
+    external_references_.push_back(reinterpret_cast<intptr_t>(callback));
+  }
+
+  // Returns the null-terminated list V8 expects.
+  const intptr_t* external_references() {
+    if (!finalized_) {
+      external_references_.push_back(0);
+      finalized_ = true;
+    }
+    return external_references_.data();
+  }
+
+ private:
+  std::vector<intptr_t> external_references_;
+  bool finalized_ = false;
+};
+
 enum EmbedderKeys {
   kBindingCache,
   kInspector,
@@ -263,7 +295,7 @@ static v8::Eternal<v8::Function> exit_handler;
 static v8::Eternal<v8::Function> promise_callback;
 
 class ZeroPlatform;
-static ZeroPlatform* platform;
+extern ZeroPlatform* platform;
 
 namespace loader {
 class ModuleWrap;
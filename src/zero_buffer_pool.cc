@@ -0,0 +1,111 @@
+#include <vector>
+
+#include "v8.h"
+#include "zero.h"
+#include "zero_buffer_pool.h"
+
+using v8::ArrayBuffer;
+using v8::Global;
+using v8::Isolate;
+using v8::Local;
+using v8::Uint8Array;
+
+namespace zero {
+
+namespace {
+
+const size_t kClasses = 8;  // 512 bytes through 64 KiB
+const size_t kMaxFreePerClass = 32;
+
+std::vector<char*> free_lists[kClasses];
+BufferPool::Stats stats = { 0, 0, 0 };
+
+// Returns the size class for |size|, or kClasses if it is too large.
+size_t ClassFor(size_t size) {
+  size_t index = 0;
+  while (index < kClasses && (BufferPool::kMinSize << index) < size) {
+    index += 1;
+  }
+  return index;
+}
+
+// Owns a pooled allocation while it is reachable from JS.
+class PooledArrayBuffer {
+ public:
+  PooledArrayBuffer(Isolate* isolate,
+                    Local<ArrayBuffer> buffer,
+                    char* data,
+                    size_t capacity)
+    : data_(data), capacity_(capacity) {
+    handle_.Reset(isolate, buffer);
+    handle_.SetWeak(this, OnCollected, v8::WeakCallbackType::kParameter);
+  }
+
+ private:
+  static void OnCollected(const v8::WeakCallbackInfo<PooledArrayBuffer>& info) {
+    PooledArrayBuffer* self = info.GetParameter();
+    self->handle_.Reset();
+    info.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(self->capacity_));
+    stats.outstanding -= self->capacity_;
+    BufferPool::Release(self->data_, self->capacity_);
+    delete self;
+  }
+
+  Global<ArrayBuffer> handle_;
+  char* data_;
+  size_t capacity_;
+};
+
+}  // anonymous namespace
+
+char* BufferPool::Acquire(size_t size, size_t* capacity) {
+  size_t index = ClassFor(size);
+  if (index == kClasses) {
+    stats.misses += 1;
+    *capacity = size;
+    return Malloc(size);
+  }
+
+  *capacity = kMinSize << index;
+  std::vector<char*>& list = free_lists[index];
+  if (list.empty()) {
+    stats.misses += 1;
+    return Malloc(*capacity);
+  }
+
+  stats.hits += 1;
+  char* data = list.back();
+  list.pop_back();
+  return data;
+}
+
+void BufferPool::Release(char* data, size_t capacity) {
+  size_t index = ClassFor(capacity);
+  if (index == kClasses ||
+      (kMinSize << index) != capacity ||
+      free_lists[index].size() >= kMaxFreePerClass) {
+    free(data);
+    return;
+  }
+  free_lists[index].push_back(data);
+}
+
+Local<Uint8Array> BufferPool::Wrap(Isolate* isolate,
+                                   char* data,
+                                   size_t capacity,
+                                   size_t length) {
+  // The ArrayBuffer only spans |length| so stale bytes from an earlier use of
+  // the allocation are never visible.
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, data, length);
+  new PooledArrayBuffer(isolate, buffer, data, capacity);
+  isolate->AdjustAmountOfExternalAllocatedMemory(capacity);
+  stats.outstanding += capacity;
+  return Uint8Array::New(buffer, 0, length);
+}
+
+const BufferPool::Stats& BufferPool::GetStats() {
+  return stats;
+}
+
+}  // namespace zero
@@ -0,0 +1,45 @@
+#ifndef SRC_ZERO_BUFFER_POOL_H_
+#define SRC_ZERO_BUFFER_POOL_H_
+
+#include <cstddef>
+
+#include "v8.h"
+
+namespace zero {
+
+// Recycles the backing memory of buffers handed to JS by native code, such as
+// the result of an fs read. Requests are rounded up to a power of two size
+// class between kMinSize and kMaxSize, and each class keeps a bounded free
+// list. Larger requests go straight to malloc.
+//
+// Not thread-safe; only use it from the loop thread.
+class BufferPool {
+ public:
+  static const size_t kMinSize = 512;
+  static const size_t kMaxSize = 64 * 1024;
+
+  // Returns at least |size| bytes and stores the usable size in |capacity|,
+  // which must be passed back to Release.
+  static char* Acquire(size_t size, size_t* capacity);
+  static void Release(char* data, size_t capacity);
+
+  // Exposes the first |length| bytes of |data| to JS. The memory goes back to
+  // the pool once the returned array's buffer is garbage collected. |data|
+  // may come from Acquire or from Malloc with |capacity| bytes.
+  static v8::Local<v8::Uint8Array> Wrap(v8::Isolate* isolate,
+                                        char* data,
+                                        size_t capacity,
+                                        size_t length);
+
+  struct Stats {
+    size_t hits;
+    size_t misses;
+    size_t outstanding;  // bytes currently owned by JS
+  };
+
+  static const Stats& GetStats();
+};
+
+}  // namespace zero
+
+#endif  // SRC_ZERO_BUFFER_POOL_H_
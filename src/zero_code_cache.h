@@ -0,0 +1,17 @@
+#ifndef SRC_ZERO_CODE_CACHE_H_
+#define SRC_ZERO_CODE_CACHE_H_
+
+#include "v8.h"
+
+namespace zero {
+namespace code_cache {
+
+// Returns the code cache generated by `zero --build-code-cache` for the
+// builtin named `specifier`, or nullptr if there is none. The returned data
+// does not own its buffer, which lives in the binary.
+v8::ScriptCompiler::CachedData* Get(const char* specifier);
+
+}  // namespace code_cache
+}  // namespace zero
+
+#endif  // SRC_ZERO_CODE_CACHE_H_
@@ -0,0 +1,14 @@
+#include "zero_code_cache.h"
+
+// Linked into out/zero_mksnapshot, which is used to generate the real
+// code cache in out/zero_code_cache.cc.
+
+namespace zero {
+namespace code_cache {
+
+v8::ScriptCompiler::CachedData* Get(const char* specifier) {
+  return nullptr;
+}
+
+}  // namespace code_cache
+}  // namespace zero
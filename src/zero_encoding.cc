@@ -190,7 +190,14 @@ void Init(Local<Context> context, Local<Object> target) {
   ZERO_SET_PROPERTY(context, target, "FLAGS_IGNORE_BOM", Decoder::FLAGS_IGNORE_BOM);
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Decoder::Create);
+  registry->Register(Decoder::Decode);
+  registry->Register(EncodeUtf8String);
+}
+
 }  // namespace encoding
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(encoding, zero::encoding::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(encoding, zero::encoding::RegisterExternalReferences);
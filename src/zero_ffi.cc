@@ -230,7 +230,17 @@ void Init(Local<Context> context, Local<Object> target) {
 #undef V
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(WritePointer);
+  registry->Register(ReadPointer);
+  registry->Register(ReadCString);
+  registry->Register(PrepCif);
+  registry->Register(Call);
+  registry->Register(Dlopen);
+}
+
 }  // namespace ffi
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(ffi, zero::ffi::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(ffi, zero::ffi::RegisterExternalReferences);
@@ -1,8 +1,22 @@
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <uv.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "v8.h"
 #include "zero.h"
+#include "zero_buffer_pool.h"
+#include "zero_uring.h"
+
+#ifdef __linux__
+#include <linux/fs.h>  // FICLONE
+#endif
 
 using v8::Array;
 using v8::ArrayBuffer;
@@ -37,8 +51,12 @@ class ZeroReq {
     }
 
   ~ZeroReq() {
+    if (pooled_ != nullptr) {
+      BufferPool::Release(pooled_, capacity_);
+    }
     isolate_ = nullptr;
     resolver_.Reset();
+    target_.Reset();
   }
 
   inline Isolate* isolate() const { return isolate_; }
@@ -51,6 +69,25 @@ class ZeroReq {
     return resolver_.Get(isolate_)->GetPromise();
   }
 
+  // Reads into memory from the BufferPool, which is returned to the pool
+  // unless TakePooled() hands it to JS.
+  inline uv_buf_t UsePooled(size_t size) {
+    pooled_ = BufferPool::Acquire(size, &capacity_);
+    return uv_buf_init(pooled_, size);
+  }
+  inline Local<Value> TakePooled(size_t length) {
+    char* data = pooled_;
+    pooled_ = nullptr;
+    return BufferPool::Wrap(isolate_, data, capacity_, length);
+  }
+
+  // Keeps the JS object that owns the memory of a request alive until it
+  // completes.
+  inline void SetTarget(Local<Object> target) {
+    target_.Reset(isolate_, target);
+  }
+  inline bool has_target() const { return !target_.IsEmpty(); }
+
   inline void finish(Local<Value> v) {
     v8::HandleScope scope(isolate_);
     Local<Context> context = isolate_->GetCurrentContext();
@@ -78,8 +115,61 @@ class ZeroReq {
   char* type_;
   void* data_;
   Persistent<Promise::Resolver> resolver_;
+  Persistent<Object> target_;
+  char* pooled_ = nullptr;
+  size_t capacity_ = 0;
 };
 
+// Layout of one stat result. stat, fstat and statMany write results into a
+// Float64Array, kStatFields slots per path. The time slots hold int64
+// nanoseconds since the epoch, which JS reads through a BigInt64Array over
+// the same memory.
+enum StatField {
+  kStatDev,
+  kStatMode,
+  kStatNlink,
+  kStatUid,
+  kStatGid,
+  kStatRdev,
+  kStatIno,
+  kStatSize,
+  kStatBlksize,
+  kStatBlocks,
+  kStatFlags,
+  kStatGen,
+  kStatATime,
+  kStatMTime,
+  kStatCTime,
+  kStatBirthTime,
+  kStatError,  // 0, or the error code of a failed statMany entry
+  kStatFields,
+};
+
+static void SetTime(double* fields, int index, const uv_timespec_t& ts) {
+  int64_t ns = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  memcpy(&fields[index], &ns, sizeof(ns));
+}
+
+static void FillStats(const uv_stat_t* s, double* fields) {
+  fields[kStatDev] = s->st_dev;
+  fields[kStatMode] = s->st_mode;
+  fields[kStatNlink] = s->st_nlink;
+  fields[kStatUid] = s->st_uid;
+  fields[kStatGid] = s->st_gid;
+  fields[kStatRdev] = s->st_rdev;
+  fields[kStatIno] = s->st_ino;
+  fields[kStatSize] = s->st_size;
+  fields[kStatBlksize] = s->st_blksize;
+  fields[kStatBlocks] = s->st_blocks;
+  fields[kStatFlags] = s->st_flags;
+  fields[kStatGen] = s->st_gen;
+  SetTime(fields, kStatATime, s->st_atim);
+  SetTime(fields, kStatMTime, s->st_mtim);
+  SetTime(fields, kStatCTime, s->st_ctim);
+  SetTime(fields, kStatBirthTime, s->st_birthtim);
+  fields[kStatError] = 0;
+}
+
 Local<Value> normalize_req(Isolate* isolate, uv_fs_t* req) {
   if (req->fs_type == UV_FS_ACCESS)
     return v8::Boolean::New(isolate, req->result >= 0);
@@ -104,8 +194,35 @@ Local<Value> normalize_req(Isolate* isolate, uv_fs_t* req) {
     case UV_FS_FCHOWN:
     case UV_FS_UTIME:
     case UV_FS_FUTIME:
+    case UV_FS_CLOSEDIR:
       return v8::Boolean::New(isolate, true);
 
+    case UV_FS_OPENDIR: {
+      // libuv leaves the entry array to the caller; see Readdir.
+      uv_dir_t* dir = static_cast<uv_dir_t*>(req->ptr);
+      dir->dirents = nullptr;
+      dir->nentries = 0;
+      return External::New(isolate, dir);
+    }
+
+    case UV_FS_READDIR: {
+      const uv_dir_t* dir = static_cast<uv_dir_t*>(req->ptr);
+      size_t count = req->result;
+      Local<Array> names = Array::New(isolate, count);
+      Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, count);
+      uint8_t* types = static_cast<uint8_t*>(buffer->GetContents().Data());
+      for (size_t i = 0; i < count; i += 1) {
+        USE(names->Set(context, i, ZERO_STRING(isolate, dir->dirents[i].name)));
+        types[i] = dir->dirents[i].type;
+      }
+      // frees the names
+      uv_fs_req_cleanup(req);
+      Local<Array> batch = Array::New(isolate, 2);
+      USE(batch->Set(context, 0, names));
+      USE(batch->Set(context, 1, v8::Uint8Array::New(buffer, 0, count)));
+      return batch;
+    }
+
     case UV_FS_OPEN:
     case UV_FS_SENDFILE:
     case UV_FS_WRITE:
@@ -113,55 +230,9 @@ Local<Value> normalize_req(Isolate* isolate, uv_fs_t* req) {
 
     case UV_FS_STAT:
     case UV_FS_LSTAT:
-    case UV_FS_FSTAT: {
-      const uv_stat_t* s = &req->statbuf;
-      Local<Array> table = Array::New(isolate);
-      int i = 0;
-#define V(name) \
-      USE(table->Set(context, i++, v8::Integer::New(isolate, s->st_##name)))
-      V(dev);
-      V(mode);
-      V(nlink);
-      V(uid);
-      V(gid);
-      V(rdev);
-      V(ino);
-      V(size);
-      V(blksize);
-      V(blocks);
-      V(flags);
-      V(gen);
-#undef V
-#define V(name) \
-      USE(table->Set(context, i++, v8::BigInt::New(isolate, s->st_##name.tv_sec))); \
-      USE(table->Set(context, i++, v8::BigInt::New(isolate, s->st_##name.tv_nsec)));
-      V(atim);
-      V(mtim);
-      V(ctim);
-      V(birthtim);
-#undef V
-      const char* type = NULL;
-      if (S_ISREG(s->st_mode))
-        type = "file";
-      else if (S_ISDIR(s->st_mode))
-        type = "directory";
-      else if (S_ISLNK(s->st_mode))
-        type = "link";
-      else if (S_ISFIFO(s->st_mode))
-        type = "fifo";
-#ifdef S_ISSOCK
-      else if (S_ISSOCK(s->st_mode))
-        type = "socket";
-#endif
-      else if (S_ISCHR(s->st_mode))
-        type = "char";
-      else if (S_ISBLK(s->st_mode))
-        type = "block";
-      if (type)
-        USE(table->Set(context, ZERO_STRING(isolate, "type"), ZERO_STRING(isolate, type)));
-
-      return table;
-    }
+    case UV_FS_FSTAT:
+      FillStats(&req->statbuf, static_cast<double*>(data->data()));
+      return v8::Undefined(isolate);
 
     case UV_FS_MKDTEMP:
       return ZERO_STRING(isolate, req->path);
@@ -171,9 +242,10 @@ Local<Value> normalize_req(Isolate* isolate, uv_fs_t* req) {
       return ZERO_STRING(isolate, reinterpret_cast<char*>(req->ptr));
 
     case UV_FS_READ:
-      return v8::Uint8Array::New(
-          ArrayBuffer::New(isolate, reinterpret_cast<char*>(data->data()), req->result),
-          0, req->result);
+      if (data->has_target()) {
+        return Number::New(isolate, req->result);
+      }
+      return data->TakePooled(req->result);
 
     case UV_FS_SCANDIR: {
       Local<Array> table = Array::New(isolate, 0);
@@ -215,6 +287,10 @@ void fs_cb(uv_fs_t* req) {
 
 #define FS_CALL(func, args, oobData, ...) {                                   \
   ZeroReq* data = new ZeroReq(args.GetIsolate(), #func, oobData);             \
+  FS_CALL_REQ(func, args, data, __VA_ARGS__);                                 \
+}
+
+#define FS_CALL_REQ(func, args, data, ...) {                                  \
   uv_fs_t* req = new uv_fs_t;                                                 \
   req->data = data;                                                           \
   args.GetReturnValue().Set(data->promise());                                 \
@@ -226,32 +302,94 @@ void fs_cb(uv_fs_t* req) {
   }                                                                           \
 }
 
+// Like FS_CALL, but for the operations the io_uring backend implements. They
+// go through the ring when it is enabled and has room, and through the libuv
+// threadpool otherwise.
+#define FS_CALL_URING(func, args, oobData, ...) {                             \
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), #func, oobData);             \
+  FS_CALL_URING_REQ(func, args, data, __VA_ARGS__);                           \
+}
+
+#define FS_CALL_URING_REQ(func, args, data, ...) {                            \
+  uv_fs_t* req = new uv_fs_t;                                                 \
+  req->data = data;                                                           \
+  args.GetReturnValue().Set(data->promise());                                 \
+  int ret = uring::fs_##func(req, __VA_ARGS__, fs_cb);                        \
+  if (ret == UV_ENOSYS) {                                                     \
+    ret = uv_fs_##func(uv_default_loop(), req, __VA_ARGS__, fs_cb);           \
+  }                                                                           \
+  if (ret < 0) {                                                              \
+    data->fail(ret);                                                          \
+    delete data;                                                              \
+    delete req;                                                               \
+  }                                                                           \
+}
+
 static void Open(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   String::Utf8Value path(isolate, args[0]);
   int flags = args[1]->Int32Value();
   int mode = args[2]->Int32Value();
 
-  FS_CALL(open, args, nullptr, *path, flags, mode);
+  FS_CALL_URING(open, args, nullptr, *path, flags, mode);
 }
 
 static void Close(const FunctionCallbackInfo<Value>& args) {
   uv_file file = args[0]->Int32Value();
 
-  FS_CALL(close, args, nullptr, file);
+  FS_CALL_URING(close, args, nullptr, file);
+}
+
+static uv_buf_t BufFromView(Local<ArrayBufferView> view) {
+  ArrayBuffer::Contents contents = view->Buffer()->GetContents();
+  char* base = static_cast<char*>(contents.Data()) + view->ByteOffset();
+  return uv_buf_init(base, view->ByteLength());
 }
 
+// Maps an array of ArrayBufferViews onto uv_buf_ts. libuv copies the array
+// itself, so |bufs| only has to live until the uv_fs call returns.
+static void BufsFromViews(Local<Context> context,
+                          Local<Array> views,
+                          std::vector<uv_buf_t>* bufs) {
+  uint32_t length = views->Length();
+  bufs->reserve(length);
+  for (uint32_t i = 0; i < length; i += 1) {
+    Local<Value> view = views->Get(context, i).ToLocalChecked();
+    bufs->push_back(BufFromView(view.As<ArrayBufferView>()));
+  }
+}
+
+// stat(path, fields) and fstat(fd, fields) fill the first kStatFields slots
+// of the Float64Array |fields|.
 static void Stat(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   String::Utf8Value path(isolate, args[0]);
+  Local<ArrayBufferView> fields = args[1].As<ArrayBufferView>();
+
+  ZeroReq* data = new ZeroReq(isolate, "stat", BufFromView(fields).base);
+  data->SetTarget(fields);
 
-  FS_CALL(stat, args, nullptr, *path);
+  FS_CALL_URING_REQ(stat, args, data, *path);
 }
 
 static void FStat(const FunctionCallbackInfo<Value>& args) {
   uv_file file = args[0]->Int32Value();
+  Local<ArrayBufferView> fields = args[1].As<ArrayBufferView>();
 
-  FS_CALL(fstat, args, nullptr, file);
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "fstat", BufFromView(fields).base);
+  data->SetTarget(fields);
+
+  FS_CALL_URING_REQ(fstat, args, data, file);
+}
+
+static void FSync(const FunctionCallbackInfo<Value>& args) {
+  uv_file file = args[0]->Int32Value();
+
+  FS_CALL_URING(fsync, args, nullptr, file);
+}
+
+static void GetBackend(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(ZERO_STRING(args.GetIsolate(), uring::Backend()));
 }
 
 static void Read(const FunctionCallbackInfo<Value>& args) {
@@ -259,29 +397,72 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
   int64_t len = args[1]->IntegerValue();
   int64_t offset = args[2]->IntegerValue();
 
-  char* buffer = Malloc(len);
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "read");
+  uv_buf_t buf = data->UsePooled(len);
 
-  uv_buf_t buf = uv_buf_init(buffer, len);
+  FS_CALL_URING_REQ(read, args, data, file, &buf, 1, offset);
+}
 
-  FS_CALL(read, args, buf.base, file, &buf, 1, offset);
+// readInto(fd, view, position) reads into the memory of |view| and resolves
+// with the number of bytes read.
+static void ReadInto(const FunctionCallbackInfo<Value>& args) {
+  uv_file file = args[0]->Uint32Value();
+  Local<ArrayBufferView> view = args[1].As<ArrayBufferView>();
+  int64_t offset = args[2]->IntegerValue();
+
+  uv_buf_t buf = BufFromView(view);
+
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "read");
+  data->SetTarget(view);
+
+  FS_CALL_URING_REQ(read, args, data, file, &buf, 1, offset);
 }
 
 static void Write(const FunctionCallbackInfo<Value>& args) {
   uv_file file = args[0]->Uint32Value();
   int64_t offset = args[1]->IntegerValue();
+  Local<ArrayBufferView> view = args[2].As<ArrayBufferView>();
 
-  Local<ArrayBufferView> ui = args[2].As<ArrayBufferView>();
-  ArrayBuffer::Contents ab_c = ui->Buffer()->GetContents();
-  auto base = static_cast<char*>(ab_c.Data()) + ui->ByteOffset();
+  uv_buf_t buf = BufFromView(view);
 
-  uv_buf_t buf[] = {
-    {
-      .base = base,
-      .len = static_cast<size_t>(ab_c.ByteLength()),
-    },
-  };
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "write");
+  data->SetTarget(view);
 
-  FS_CALL(write, args, nullptr, file, buf, 1, offset);
+  FS_CALL_URING_REQ(write, args, data, file, &buf, 1, offset);
+}
+
+// readv(fd, views, position) fills |views| in order and resolves with the
+// total number of bytes read.
+static void ReadV(const FunctionCallbackInfo<Value>& args) {
+  Local<Context> context = args.GetIsolate()->GetCurrentContext();
+  uv_file file = args[0]->Uint32Value();
+  Local<Array> views = args[1].As<Array>();
+  int64_t offset = args[2]->IntegerValue();
+
+  std::vector<uv_buf_t> bufs;
+  BufsFromViews(context, views, &bufs);
+
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "readv");
+  data->SetTarget(views);
+
+  FS_CALL_URING_REQ(read, args, data, file, bufs.data(), bufs.size(), offset);
+}
+
+// writev(fd, position, views) writes |views| back to back with one syscall
+// and resolves with the number of bytes written.
+static void WriteV(const FunctionCallbackInfo<Value>& args) {
+  Local<Context> context = args.GetIsolate()->GetCurrentContext();
+  uv_file file = args[0]->Uint32Value();
+  int64_t offset = args[1]->IntegerValue();
+  Local<Array> views = args[2].As<Array>();
+
+  std::vector<uv_buf_t> bufs;
+  BufsFromViews(context, views, &bufs);
+
+  ZeroReq* data = new ZeroReq(args.GetIsolate(), "writev");
+  data->SetTarget(views);
+
+  FS_CALL_URING_REQ(write, args, data, file, bufs.data(), bufs.size(), offset);
 }
 
 static void Scandir(const FunctionCallbackInfo<Value>& args) {
@@ -291,6 +472,43 @@ static void Scandir(const FunctionCallbackInfo<Value>& args) {
   FS_CALL(scandir, args, nullptr, *path, 0);
 }
 
+// opendir(path) resolves with a handle for readdir and closedir. Unlike
+// scandir, entries are read a batch at a time, so memory use doesn't grow
+// with the size of the directory.
+static void Opendir(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  String::Utf8Value path(isolate, args[0]);
+
+  FS_CALL(opendir, args, nullptr, *path);
+}
+
+// readdir(dir, size) resolves with [names, types] for up to |size| entries,
+// where types is a Uint8Array of UV_DIRENT_* values. Both are empty at the
+// end of the directory.
+static void Readdir(const FunctionCallbackInfo<Value>& args) {
+  uv_dir_t* dir = static_cast<uv_dir_t*>(args[0].As<External>()->Value());
+  uint32_t size = args[1]->Uint32Value();
+
+  // The entry array is reused by later calls and freed by closedir.
+  if (dir->nentries != size) {
+    delete[] dir->dirents;
+    dir->dirents = new uv_dirent_t[size];
+    dir->nentries = size;
+  }
+
+  FS_CALL(readdir, args, nullptr, dir);
+}
+
+static void Closedir(const FunctionCallbackInfo<Value>& args) {
+  uv_dir_t* dir = static_cast<uv_dir_t*>(args[0].As<External>()->Value());
+
+  delete[] dir->dirents;
+  dir->dirents = nullptr;
+  dir->nentries = 0;
+
+  FS_CALL(closedir, args, nullptr, dir);
+}
+
 static void Realpath(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   String::Utf8Value path(isolate, args[0]);
@@ -309,7 +527,7 @@ static void Rmdir(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   String::Utf8Value path(isolate, args[0]);
 
-  FS_CALL(unlink, args, nullptr, *path);
+  FS_CALL(rmdir, args, nullptr, *path);
 }
 
 static void Mkdir(const FunctionCallbackInfo<Value>& args) {
@@ -328,6 +546,13 @@ static void Symlink(const FunctionCallbackInfo<Value>& args) {
   FS_CALL(symlink, args, nullptr, *from, *to, 0);
 }
 
+static void Readlink(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  String::Utf8Value path(isolate, args[0]);
+
+  FS_CALL(readlink, args, nullptr, *path);
+}
+
 static void Copy(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   String::Utf8Value from(isolate, args[0]);
@@ -362,6 +587,552 @@ static void FUtime(const FunctionCallbackInfo<Value>& args) {
   FS_CALL(futime, args, nullptr, file, atime, mtime);
 }
 
+// readFile and writeFile run their whole open/read/close or open/write/close
+// sequence as one threadpool work item using synchronous uv_fs calls, so a
+// file costs one round trip and one promise resolution.
+class FileJob {
+ public:
+  FileJob(Isolate* isolate, const char* type, const char* path)
+    : req_(isolate, type), path_(path) {
+      work_.data = this;
+    }
+
+  ~FileJob() {
+    free(data_);
+  }
+
+  static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+    Isolate* isolate = args.GetIsolate();
+    String::Utf8Value path(isolate, args[0]);
+
+    FileJob* job = new FileJob(isolate, "readFile", *path);
+    job->Queue(args, DoReadFile);
+  }
+
+  // writeFile(path, view, append, sync)
+  static void WriteFile(const FunctionCallbackInfo<Value>& args) {
+    Isolate* isolate = args.GetIsolate();
+    String::Utf8Value path(isolate, args[0]);
+    Local<ArrayBufferView> view = args[1].As<ArrayBufferView>();
+
+    FileJob* job = new FileJob(isolate, "writeFile", *path);
+    uv_buf_t buf = BufFromView(view);
+    job->base_ = buf.base;
+    job->length_ = buf.len;
+    job->append_ = args[2]->IsTrue();
+    job->sync_ = args[3]->IsTrue();
+    job->req_.SetTarget(view);
+    job->Queue(args, DoWriteFile);
+  }
+
+ private:
+  void Queue(const FunctionCallbackInfo<Value>& args, uv_work_cb work) {
+    args.GetReturnValue().Set(req_.promise());
+    loop_ = uv_default_loop();
+    int err = uv_queue_work(loop_, &work_, work, AfterWork);
+    if (err < 0) {
+      req_.fail(err);
+      delete this;
+    }
+  }
+
+  int Open(int flags, int mode) {
+    uv_fs_t req;
+    int fd = uv_fs_open(loop_, &req, path_.c_str(), flags, mode, nullptr);
+    uv_fs_req_cleanup(&req);
+    return fd;
+  }
+
+  static int Close(uv_loop_t* loop, uv_file fd) {
+    uv_fs_t req;
+    int err = uv_fs_close(loop, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+    return err;
+  }
+
+  static void DoReadFile(uv_work_t* work) {
+    FileJob* job = static_cast<FileJob*>(work->data);
+    uv_loop_t* loop = job->loop_;
+    uv_fs_t req;
+
+    uv_file fd = job->Open(O_RDONLY, 0);
+    if (fd < 0) {
+      job->err_ = fd;
+      return;
+    }
+
+    // The size is only a hint; files that report none, such as those in
+    // /proc, are read until EOF.
+    size_t size = 0;
+    if (uv_fs_fstat(loop, &req, fd, nullptr) == 0) {
+      size = req.statbuf.st_size;
+    }
+    uv_fs_req_cleanup(&req);
+
+    size_t capacity = size > 0 ? size : 64 * 1024;
+    char* data = Malloc(capacity);
+    size_t total = 0;
+    for (;;) {
+      if (total == capacity) {
+        if (size > 0) {
+          break;
+        }
+        capacity *= 2;
+        data = Realloc(data, capacity);
+      }
+      uv_buf_t buf = uv_buf_init(data + total, capacity - total);
+      int r = uv_fs_read(loop, &req, fd, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (r < 0) {
+        job->err_ = r;
+        break;
+      }
+      if (r == 0) {
+        break;
+      }
+      total += r;
+    }
+
+    int err = Close(loop, fd);
+    if (job->err_ == 0) {
+      job->err_ = err;
+    }
+    job->data_ = data;
+    job->capacity_ = capacity;
+    job->length_ = total;
+  }
+
+  static void DoWriteFile(uv_work_t* work) {
+    FileJob* job = static_cast<FileJob*>(work->data);
+    uv_loop_t* loop = job->loop_;
+    uv_fs_t req;
+
+    int flags = O_WRONLY | O_CREAT | (job->append_ ? O_APPEND : O_TRUNC);
+    uv_file fd = job->Open(flags, 0666);
+    if (fd < 0) {
+      job->err_ = fd;
+      return;
+    }
+
+    size_t written = 0;
+    while (written < job->length_) {
+      uv_buf_t buf = uv_buf_init(job->base_ + written, job->length_ - written);
+      int r = uv_fs_write(loop, &req, fd, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (r < 0) {
+        job->err_ = r;
+        break;
+      }
+      written += r;
+    }
+
+    if (job->err_ == 0 && job->sync_) {
+      job->err_ = uv_fs_fsync(loop, &req, fd, nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    int err = Close(loop, fd);
+    if (job->err_ == 0) {
+      job->err_ = err;
+    }
+  }
+
+  static void AfterWork(uv_work_t* work, int status) {
+    FileJob* job = static_cast<FileJob*>(work->data);
+    Isolate* isolate = job->req_.isolate();
+    InternalCallbackScope callback_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+
+    int err = status < 0 ? status : job->err_;
+    if (err < 0) {
+      job->req_.fail(err);
+    } else if (job->data_ != nullptr) {
+      Local<Value> buffer =
+          BufferPool::Wrap(isolate, job->data_, job->capacity_, job->length_);
+      job->data_ = nullptr;
+      job->req_.finish(buffer);
+    } else {
+      job->req_.finish(v8::Undefined(isolate));
+    }
+    delete job;
+  }
+
+  ZeroReq req_;
+  std::string path_;
+  uv_loop_t* loop_ = nullptr;
+  uv_work_t work_;
+  int err_ = 0;
+
+  char* data_ = nullptr;  // read result, owned until handed to JS
+  char* base_ = nullptr;  // write source, owned by the view in req_
+  size_t capacity_ = 0;
+  size_t length_ = 0;
+  bool append_ = false;
+  bool sync_ = false;
+};
+
+// copyRange(inFd, inPosition, outFd, outPosition, length) and
+// sendfile(inFd, outFd, position, length) move bytes between descriptors
+// without copying them through JS, and resolve with the number of bytes
+// moved. Both stop early at the end of the input. An out position of -1
+// means the current position of outFd.
+class TransferJob {
+ public:
+  static void CopyRange(const FunctionCallbackInfo<Value>& args) {
+    TransferJob* job = new TransferJob(args.GetIsolate(), "copyRange");
+    job->in_ = args[0]->Int32Value();
+    job->in_position_ = args[1]->IntegerValue();
+    job->out_ = args[2]->Int32Value();
+    job->out_position_ = args[3]->IntegerValue();
+    job->length_ = args[4]->IntegerValue();
+    job->Queue(args, DoCopyRange);
+  }
+
+  static void SendFile(const FunctionCallbackInfo<Value>& args) {
+    TransferJob* job = new TransferJob(args.GetIsolate(), "sendfile");
+    job->in_ = args[0]->Int32Value();
+    job->out_ = args[1]->Int32Value();
+    job->in_position_ = args[2]->IntegerValue();
+    job->out_position_ = -1;
+    job->length_ = args[3]->IntegerValue();
+    job->Queue(args, DoSendFile);
+  }
+
+ private:
+  TransferJob(Isolate* isolate, const char* type) : req_(isolate, type) {
+    work_.data = this;
+  }
+
+  ~TransferJob() {
+    if (poll_ != nullptr) {
+      uv_close(reinterpret_cast<uv_handle_t*>(poll_), [](uv_handle_t* handle) {
+        delete reinterpret_cast<uv_poll_t*>(handle);
+      });
+    }
+  }
+
+  void Queue(const FunctionCallbackInfo<Value>& args, uv_work_cb work) {
+    args.GetReturnValue().Set(req_.promise());
+    loop_ = uv_default_loop();
+    int err = uv_queue_work(loop_, &work_, work, AfterWork);
+    if (err < 0) {
+      req_.fail(err);
+      delete this;
+    }
+  }
+
+  // A fresh copy of a whole file can share the source's extents on file
+  // systems with reflinks, such as btrfs and XFS.
+  bool TryClone() {
+#ifdef FICLONE
+    struct stat in, out;
+    if (in_position_ != 0 || out_position_ > 0 ||
+        fstat(in_, &in) != 0 || fstat(out_, &out) != 0 ||
+        out.st_size != 0 || length_ < in.st_size ||
+        ioctl(out_, FICLONE, in_) != 0) {
+      return false;
+    }
+    done_ = in.st_size;
+    if (out_position_ < 0) {
+      lseek(out_, done_, SEEK_CUR);
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static void DoCopyRange(uv_work_t* work) {
+    TransferJob* job = static_cast<TransferJob*>(work->data);
+    if (job->TryClone()) {
+      return;
+    }
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+    loff_t in_off = job->in_position_;
+    loff_t out_off = job->out_position_;
+    while (job->done_ < job->length_) {
+      ssize_t n = syscall(SYS_copy_file_range,
+                          job->in_, &in_off,
+                          job->out_, job->out_position_ < 0 ? nullptr : &out_off,
+                          job->length_ - job->done_, 0);
+      if (n < 0) {
+        // Not supported between these files; copy the rest by hand.
+        if (errno == ENOSYS || errno == EXDEV ||
+            errno == EINVAL || errno == EOPNOTSUPP) {
+          break;
+        }
+        job->err_ = -errno;
+        return;
+      }
+      if (n == 0) {
+        return;
+      }
+      job->done_ += n;
+    }
+#endif
+
+    job->CopyByHand();
+  }
+
+  void CopyByHand() {
+    const size_t kChunkSize = 64 * 1024;
+    char* data = Malloc(kChunkSize);
+    while (done_ < length_) {
+      uv_fs_t req;
+      size_t size = std::min<int64_t>(length_ - done_, kChunkSize);
+      uv_buf_t buf = uv_buf_init(data, size);
+      int r = uv_fs_read(loop_, &req, in_, &buf, 1, in_position_ + done_, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (r <= 0) {
+        err_ = r;
+        break;
+      }
+      for (int written = 0; written < r;) {
+        buf = uv_buf_init(data + written, r - written);
+        int64_t offset = out_position_ < 0 ? -1 : out_position_ + done_ + written;
+        int w = uv_fs_write(loop_, &req, out_, &buf, 1, offset, nullptr);
+        uv_fs_req_cleanup(&req);
+        if (w < 0) {
+          err_ = w;
+          break;
+        }
+        written += w;
+      }
+      if (err_ < 0) {
+        break;
+      }
+      done_ += r;
+    }
+    free(data);
+  }
+
+  static void DoSendFile(uv_work_t* work) {
+    TransferJob* job = static_cast<TransferJob*>(work->data);
+    while (job->done_ < job->length_) {
+      uv_fs_t req;
+      int r = uv_fs_sendfile(job->loop_, &req, job->out_, job->in_,
+                             job->in_position_ + job->done_,
+                             job->length_ - job->done_, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (r == UV_EAGAIN) {
+        // Sockets and pipes from the loop are non-blocking. Rather than
+        // hold on to a threadpool thread, wait on the loop until there is
+        // room and queue the rest again.
+        job->would_block_ = true;
+        return;
+      }
+      if (r < 0) {
+        job->err_ = r;
+        return;
+      }
+      if (r == 0) {
+        return;
+      }
+      job->done_ += r;
+    }
+  }
+
+  // Polls the target for room to write. Like any uv_poll_t, this must not
+  // race another handle watching the same descriptor.
+  int WaitWritable() {
+    if (poll_ == nullptr) {
+      poll_ = new uv_poll_t;
+      int err = uv_poll_init(loop_, poll_, out_);
+      if (err < 0) {
+        delete poll_;
+        poll_ = nullptr;
+        return err;
+      }
+      poll_->data = this;
+    }
+    return uv_poll_start(poll_, UV_WRITABLE, OnWritable);
+  }
+
+  static void OnWritable(uv_poll_t* handle, int status, int events) {
+    TransferJob* job = static_cast<TransferJob*>(handle->data);
+    uv_poll_stop(handle);
+    int err = status < 0 ?
+      status :
+      uv_queue_work(job->loop_, &job->work_, DoSendFile, AfterWork);
+    if (err < 0) {
+      job->err_ = err;
+      AfterWork(&job->work_, 0);
+    }
+  }
+
+  static void AfterWork(uv_work_t* work, int status) {
+    TransferJob* job = static_cast<TransferJob*>(work->data);
+    int err = status < 0 ? status : job->err_;
+
+    if (err == 0 && job->would_block_) {
+      job->would_block_ = false;
+      err = job->WaitWritable();
+      if (err == 0) {
+        return;
+      }
+    }
+
+    Isolate* isolate = job->req_.isolate();
+    InternalCallbackScope callback_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+
+    if (err < 0) {
+      job->req_.fail(err);
+    } else {
+      job->req_.finish(Number::New(isolate, job->done_));
+    }
+    delete job;
+  }
+
+  ZeroReq req_;
+  uv_loop_t* loop_ = nullptr;
+  uv_work_t work_;
+  int err_ = 0;
+
+  uv_file in_ = -1;
+  uv_file out_ = -1;
+  int64_t in_position_ = 0;
+  int64_t out_position_ = -1;
+  int64_t length_ = 0;
+  int64_t done_ = 0;
+  bool would_block_ = false;
+  uv_poll_t* poll_ = nullptr;
+};
+
+// Enough work items to occupy libuv's default threadpool without flooding it.
+static const size_t kStatManyChunks = 4;
+static const size_t kStatManyMinChunkSize = 16;
+
+// statMany(paths, fields) stats every path in |paths|, writing the result
+// for paths[i] to slot i * kStatFields of the Float64Array |fields|. The paths
+// are split into a few work items so they are stat()ed in parallel on the
+// threadpool, and the promise resolves once all of them are done. Failures
+// are reported per path in the kStatError slot rather than rejecting.
+class StatManyJob {
+ public:
+  static void StatMany(const FunctionCallbackInfo<Value>& args) {
+    Isolate* isolate = args.GetIsolate();
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Array> paths = args[0].As<Array>();
+    Local<ArrayBufferView> fields = args[1].As<ArrayBufferView>();
+
+    uint32_t length = paths->Length();
+    if (fields->ByteLength() < length * kStatFields * sizeof(double)) {
+      ZERO_THROW_EXCEPTION(isolate, "statMany: fields is too small");
+      return;
+    }
+
+    StatManyJob* job = new StatManyJob(isolate);
+    job->fields_ = reinterpret_cast<double*>(BufFromView(fields).base);
+    job->req_.SetTarget(fields);
+    job->paths_.reserve(length);
+    for (uint32_t i = 0; i < length; i += 1) {
+      Local<Value> path = paths->Get(context, i).ToLocalChecked();
+      job->paths_.emplace_back(*String::Utf8Value(isolate, path));
+    }
+
+    args.GetReturnValue().Set(job->req_.promise());
+    job->Queue();
+  }
+
+ private:
+  struct Chunk {
+    uv_work_t work;
+    StatManyJob* job;
+    size_t begin;
+    size_t end;
+  };
+
+  explicit StatManyJob(Isolate* isolate) : req_(isolate, "statMany") {}
+
+  void Queue() {
+    uv_loop_t* loop = uv_default_loop();
+    size_t length = paths_.size();
+    size_t chunk_size = std::max((length + kStatManyChunks - 1) / kStatManyChunks,
+                                 kStatManyMinChunkSize);
+
+    // Sized up front; the uv_work_ts must not move once queued.
+    chunks_.resize((length + chunk_size - 1) / chunk_size);
+    for (size_t i = 0; i < chunks_.size(); i += 1) {
+      Chunk& chunk = chunks_[i];
+      chunk.work.data = &chunk;
+      chunk.job = this;
+      chunk.begin = i * chunk_size;
+      chunk.end = std::min(chunk.begin + chunk_size, length);
+      int err = uv_queue_work(loop, &chunk.work, DoStat, AfterStat);
+      if (err < 0) {
+        err_ = err;
+      } else {
+        pending_ += 1;
+      }
+    }
+
+    if (pending_ == 0) {
+      Finish();
+    }
+  }
+
+  static void DoStat(uv_work_t* work) {
+    Chunk* chunk = static_cast<Chunk*>(work->data);
+    StatManyJob* job = chunk->job;
+    // The loop is only used to satisfy the signature of synchronous calls.
+    uv_loop_t* loop = uv_default_loop();
+    for (size_t i = chunk->begin; i < chunk->end; i += 1) {
+      double* fields = job->fields_ + i * kStatFields;
+      uv_fs_t req;
+      int err = uv_fs_stat(loop, &req, job->paths_[i].c_str(), nullptr);
+      if (err < 0) {
+        fields[kStatError] = err;
+      } else {
+        FillStats(&req.statbuf, fields);
+      }
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  static void AfterStat(uv_work_t* work, int status) {
+    StatManyJob* job = static_cast<Chunk*>(work->data)->job;
+    if (status < 0) {
+      job->err_ = status;
+    }
+    job->pending_ -= 1;
+    if (job->pending_ == 0) {
+      InternalCallbackScope callback_scope(job->req_.isolate());
+      job->Finish();
+    }
+  }
+
+  void Finish() {
+    v8::HandleScope handle_scope(req_.isolate());
+    if (err_ < 0) {
+      req_.fail(err_);
+    } else {
+      req_.finish(v8::Undefined(req_.isolate()));
+    }
+    delete this;
+  }
+
+  ZeroReq req_;
+  std::vector<std::string> paths_;
+  std::vector<Chunk> chunks_;
+  double* fields_ = nullptr;  // owned by the Float64Array in req_
+  size_t pending_ = 0;
+  int err_ = 0;
+};
+
+static void GetBufferPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+
+  const BufferPool::Stats& stats = BufferPool::GetStats();
+  Local<Object> result = Object::New(isolate);
+  ZERO_SET_PROPERTY(context, result, "hits", stats.hits);
+  ZERO_SET_PROPERTY(context, result, "misses", stats.misses);
+  ZERO_SET_PROPERTY(context, result, "outstanding", stats.outstanding);
+  args.GetReturnValue().Set(result);
+}
+
 class ZeroEvent {
  public:
   ZeroEvent(Isolate* isolate, Local<Value> cb) :
@@ -420,20 +1191,35 @@ void Init(Local<Context> context, Local<Object> exports) {
   ZERO_SET_PROPERTY(context, exports, "close", Close);
   ZERO_SET_PROPERTY(context, exports, "stat", Stat);
   ZERO_SET_PROPERTY(context, exports, "fstat", FStat);
+  ZERO_SET_PROPERTY(context, exports, "statMany", StatManyJob::StatMany);
+  ZERO_SET_PROPERTY(context, exports, "fsync", FSync);
   ZERO_SET_PROPERTY(context, exports, "read", Read);
+  ZERO_SET_PROPERTY(context, exports, "readInto", ReadInto);
   ZERO_SET_PROPERTY(context, exports, "write", Write);
+  ZERO_SET_PROPERTY(context, exports, "readv", ReadV);
+  ZERO_SET_PROPERTY(context, exports, "writev", WriteV);
+  ZERO_SET_PROPERTY(context, exports, "readFile", FileJob::ReadFile);
+  ZERO_SET_PROPERTY(context, exports, "writeFile", FileJob::WriteFile);
+  ZERO_SET_PROPERTY(context, exports, "copyRange", TransferJob::CopyRange);
+  ZERO_SET_PROPERTY(context, exports, "sendfile", TransferJob::SendFile);
   ZERO_SET_PROPERTY(context, exports, "scandir", Scandir);
+  ZERO_SET_PROPERTY(context, exports, "opendir", Opendir);
+  ZERO_SET_PROPERTY(context, exports, "readdir", Readdir);
+  ZERO_SET_PROPERTY(context, exports, "closedir", Closedir);
   ZERO_SET_PROPERTY(context, exports, "realpath", Realpath);
   ZERO_SET_PROPERTY(context, exports, "unlink", Unlink);
   ZERO_SET_PROPERTY(context, exports, "rmdir", Rmdir);
   ZERO_SET_PROPERTY(context, exports, "mkdir", Mkdir);
   ZERO_SET_PROPERTY(context, exports, "symlink", Symlink);
+  ZERO_SET_PROPERTY(context, exports, "readlink", Readlink);
   ZERO_SET_PROPERTY(context, exports, "copy", Copy);
   ZERO_SET_PROPERTY(context, exports, "rename", Rename);
   ZERO_SET_PROPERTY(context, exports, "utime", Utime);
   ZERO_SET_PROPERTY(context, exports, "futime", FUtime);
   ZERO_SET_PROPERTY(context, exports, "eventStart", EventStart);
   ZERO_SET_PROPERTY(context, exports, "eventStop", EventStop);
+  ZERO_SET_PROPERTY(context, exports, "getBufferPoolStats", GetBufferPoolStats);
+  ZERO_SET_PROPERTY(context, exports, "getBackend", GetBackend);
 
 #define V(n) ZERO_SET_PROPERTY(context, exports, #n, n);
   V(O_APPEND)
@@ -453,6 +1239,7 @@ void Init(Local<Context> context, Local<Object> exports) {
   V(S_IFREG)
   V(S_IFSOCK)
   V(UV_FS_COPYFILE_EXCL)
+  V(UV_FS_COPYFILE_FICLONE)
   V(UV_DIRENT_UNKNOWN)
   V(UV_DIRENT_FILE)
   V(UV_DIRENT_DIR)
@@ -461,10 +1248,66 @@ void Init(Local<Context> context, Local<Object> exports) {
   V(UV_DIRENT_SOCKET)
   V(UV_DIRENT_CHAR)
   V(UV_DIRENT_BLOCK)
+  V(UV_EEXIST)
+  V(kStatDev)
+  V(kStatMode)
+  V(kStatNlink)
+  V(kStatUid)
+  V(kStatGid)
+  V(kStatRdev)
+  V(kStatIno)
+  V(kStatSize)
+  V(kStatBlksize)
+  V(kStatBlocks)
+  V(kStatFlags)
+  V(kStatGen)
+  V(kStatATime)
+  V(kStatMTime)
+  V(kStatCTime)
+  V(kStatBirthTime)
+  V(kStatError)
+  V(kStatFields)
 #undef V
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Open);
+  registry->Register(Close);
+  registry->Register(Stat);
+  registry->Register(FStat);
+  registry->Register(StatManyJob::StatMany);
+  registry->Register(FSync);
+  registry->Register(Read);
+  registry->Register(ReadInto);
+  registry->Register(Write);
+  registry->Register(ReadV);
+  registry->Register(WriteV);
+  registry->Register(FileJob::ReadFile);
+  registry->Register(FileJob::WriteFile);
+  registry->Register(TransferJob::CopyRange);
+  registry->Register(TransferJob::SendFile);
+  registry->Register(Scandir);
+  registry->Register(Opendir);
+  registry->Register(Readdir);
+  registry->Register(Closedir);
+  registry->Register(Realpath);
+  registry->Register(Unlink);
+  registry->Register(Rmdir);
+  registry->Register(Mkdir);
+  registry->Register(Symlink);
+  registry->Register(Readlink);
+  registry->Register(Copy);
+  registry->Register(Rename);
+  registry->Register(Utime);
+  registry->Register(FUtime);
+  registry->Register(EventStart);
+  registry->Register(EventStop);
+  registry->Register(GetBufferPoolStats);
+  registry->Register(GetBackend);
+}
+
 }  // namespace fs
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(fs, zero::fs::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(fs, zero::fs::RegisterExternalReferences);
@@ -0,0 +1,302 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "zero_import_scanner.h"
+
+namespace zero {
+namespace loader {
+
+namespace {
+
+inline bool IsIdentifierChar(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$' || c >= 0x80;
+}
+
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+         c == '\v' || c == '\f';
+}
+
+// Keywords after which a `/` starts a regular expression rather than a
+// division.
+bool IsExpressionKeyword(const char* word, size_t length) {
+  static const char* keywords[] = {
+    "return", "typeof", "instanceof", "in", "of", "new", "delete", "void",
+    "throw", "case", "do", "else", "yield", "await",
+  };
+  for (const char* keyword : keywords) {
+    if (strlen(keyword) == length && memcmp(keyword, word, length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+class Scanner {
+ public:
+  Scanner(const char* data, size_t length) : p_(data), end_(data + length) {}
+
+  std::vector<std::string> Run() {
+    if (end_ - p_ >= 2 && p_[0] == '#' && p_[1] == '!') {
+      SkipLine();
+    }
+
+    while (p_ < end_) {
+      char c = *p_;
+
+      if (IsSpace(c)) {
+        p_ += 1;
+        continue;
+      }
+
+      if (c == '/' && Peek(1) == '/') {
+        SkipLine();
+        continue;
+      }
+      if (c == '/' && Peek(1) == '*') {
+        SkipBlockComment();
+        continue;
+      }
+
+      bool after_dot = after_dot_;
+      after_dot_ = false;
+
+      if (c == '/') {
+        if (regex_allowed_) {
+          SkipRegExp();
+          regex_allowed_ = false;
+        } else {
+          p_ += 1;
+          regex_allowed_ = true;
+        }
+      } else if (c == '\'' || c == '"') {
+        SkipString();
+        regex_allowed_ = false;
+      } else if (c == '`') {
+        p_ += 1;
+        SkipTemplate();
+        regex_allowed_ = false;
+      } else if (c == '{') {
+        braces_ += 1;
+        p_ += 1;
+        regex_allowed_ = true;
+      } else if (c == '}') {
+        p_ += 1;
+        if (!templates_.empty() && templates_.back() == braces_) {
+          // end of a ${} substitution
+          templates_.pop_back();
+          SkipTemplate();
+          regex_allowed_ = false;
+        } else {
+          braces_ -= 1;
+          regex_allowed_ = true;
+        }
+      } else if (IsIdentifierChar(c)) {
+        const char* word = p_;
+        while (p_ < end_ && IsIdentifierChar(*p_)) {
+          p_ += 1;
+        }
+        size_t length = p_ - word;
+        regex_allowed_ = IsExpressionKeyword(word, length);
+        // `import` and `export` as properties, e.g. `x.import`, are not
+        // statements.
+        if (!after_dot && length == 6) {
+          if (memcmp(word, "import", 6) == 0) {
+            ScanImport();
+          } else if (memcmp(word, "export", 6) == 0) {
+            ScanExport();
+          }
+        }
+      } else {
+        p_ += 1;
+        after_dot_ = c == '.';
+        regex_allowed_ = c != ')' && c != ']';
+      }
+    }
+
+    return std::move(specifiers_);
+  }
+
+ private:
+  char Peek(size_t offset) const {
+    return p_ + offset < end_ ? p_[offset] : '\0';
+  }
+
+  void SkipLine() {
+    while (p_ < end_ && *p_ != '\n') {
+      p_ += 1;
+    }
+  }
+
+  void SkipBlockComment() {
+    p_ += 2;
+    while (p_ < end_ && !(*p_ == '*' && Peek(1) == '/')) {
+      p_ += 1;
+    }
+    p_ = p_ < end_ ? p_ + 2 : end_;
+  }
+
+  void SkipSpaceAndComments() {
+    while (p_ < end_) {
+      if (IsSpace(*p_)) {
+        p_ += 1;
+      } else if (*p_ == '/' && Peek(1) == '/') {
+        SkipLine();
+      } else if (*p_ == '/' && Peek(1) == '*') {
+        SkipBlockComment();
+      } else {
+        return;
+      }
+    }
+  }
+
+  // Reads a string literal starting at its opening quote. Only the escapes
+  // that can appear in a specifier are decoded, which is enough here.
+  std::string ReadString() {
+    char quote = *p_;
+    p_ += 1;
+    std::string value;
+    while (p_ < end_ && *p_ != quote && *p_ != '\n') {
+      if (*p_ == '\\' && p_ + 1 < end_) {
+        p_ += 1;
+      }
+      value += *p_;
+      p_ += 1;
+    }
+    if (p_ < end_) {
+      p_ += 1;
+    }
+    return value;
+  }
+
+  void SkipString() {
+    char quote = *p_;
+    p_ += 1;
+    while (p_ < end_ && *p_ != quote && *p_ != '\n') {
+      p_ += *p_ == '\\' ? 2 : 1;
+    }
+    p_ = p_ < end_ ? p_ + 1 : end_;
+  }
+
+  // Skips template characters up to the closing backtick, or up to a ${
+  // whose matching } is found by the main loop.
+  void SkipTemplate() {
+    while (p_ < end_) {
+      if (*p_ == '\\') {
+        p_ += 2;
+      } else if (*p_ == '`') {
+        p_ += 1;
+        return;
+      } else if (*p_ == '$' && Peek(1) == '{') {
+        p_ += 2;
+        templates_.push_back(braces_);
+        regex_allowed_ = true;
+        return;
+      } else {
+        p_ += 1;
+      }
+    }
+    p_ = end_;
+  }
+
+  void SkipRegExp() {
+    p_ += 1;
+    bool in_class = false;
+    while (p_ < end_ && *p_ != '\n') {
+      char c = *p_;
+      if (c == '\\') {
+        p_ += 2;
+        continue;
+      }
+      p_ += 1;
+      if (c == '[') {
+        in_class = true;
+      } else if (c == ']') {
+        in_class = false;
+      } else if (c == '/' && !in_class) {
+        break;
+      }
+    }
+    if (p_ > end_) {
+      p_ = end_;
+    }
+    while (p_ < end_ && IsIdentifierChar(*p_)) {
+      p_ += 1;  // flags
+    }
+  }
+
+  // Reads the clause of an import or re-export up to `from '...'`. Stops at
+  // the first token that can't be part of one, such as the `;` that ends
+  // `export { a };`.
+  void ScanClause() {
+    for (;;) {
+      SkipSpaceAndComments();
+      if (p_ >= end_) {
+        return;
+      }
+      char c = *p_;
+      if (c == '{' || c == '}' || c == ',' || c == '*') {
+        p_ += 1;
+      } else if (c == '\'' || c == '"') {
+        // string names, as in `export { "a-b" as c } from '...'`
+        SkipString();
+      } else if (IsIdentifierChar(c)) {
+        const char* word = p_;
+        while (p_ < end_ && IsIdentifierChar(*p_)) {
+          p_ += 1;
+        }
+        if (p_ - word == 4 && memcmp(word, "from", 4) == 0) {
+          SkipSpaceAndComments();
+          if (p_ < end_ && (*p_ == '\'' || *p_ == '"')) {
+            specifiers_.push_back(ReadString());
+          }
+          return;
+        }
+      } else {
+        return;
+      }
+    }
+  }
+
+  void ScanImport() {
+    SkipSpaceAndComments();
+    if (p_ >= end_) {
+      return;
+    }
+    if (*p_ == '\'' || *p_ == '"') {
+      specifiers_.push_back(ReadString());
+      return;
+    }
+    if (*p_ == '(' || *p_ == '.') {
+      return;  // import() and import.meta
+    }
+    ScanClause();
+  }
+
+  void ScanExport() {
+    SkipSpaceAndComments();
+    if (p_ < end_ && (*p_ == '*' || *p_ == '{')) {
+      ScanClause();
+    }
+  }
+
+  const char* p_;
+  const char* end_;
+  std::vector<std::string> specifiers_;
+  // Brace depth at each open ${ substitution.
+  std::vector<int> templates_;
+  int braces_ = 0;
+  bool regex_allowed_ = true;
+  bool after_dot_ = false;
+};
+
+}  // anonymous namespace
+
+std::vector<std::string> ScanImports(const char* data, size_t length) {
+  return Scanner(data, length).Run();
+}
+
+}  // namespace loader
+}  // namespace zero
@@ -0,0 +1,24 @@
+#ifndef SRC_ZERO_IMPORT_SCANNER_H_
+#define SRC_ZERO_IMPORT_SCANNER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace zero {
+namespace loader {
+
+// Returns the specifiers of the static imports and `export ... from`s in the
+// UTF-8 module source |data|, in source order, without parsing or compiling
+// it. Comments, strings, template literals and regular expressions are
+// skipped, so only real import statements are reported.
+//
+// This is a lexer-level approximation used to start loading a module's
+// dependencies early. It may miss an import or report a spurious one in
+// unusual code; V8's own list of module requests remains authoritative.
+std::vector<std::string> ScanImports(const char* data, size_t length);
+
+}  // namespace loader
+}  // namespace zero
+
+#endif  // SRC_ZERO_IMPORT_SCANNER_H_
@@ -157,7 +157,14 @@ void Init(Local<Context> context, Local<Object> target) {
   ZERO_SET_PROPERTY(context, target, "stop", Stop);
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Start);
+  registry->Register(Stop);
+  registry->Register(InspectorClient::SendInspectorMessage);
+}
+
 }  // namespace inspector
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(inspector_sync, zero::inspector::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(inspector_sync, zero::inspector::RegisterExternalReferences);
@@ -0,0 +1,277 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include <uv.h>
+#include <cerrno>
+#include <string>
+#include <unordered_map>  // std::unordered_map
+
+#include "v8.h"
+#include "zero.h"
+
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Global;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+namespace zero {
+namespace mmap {
+
+class Mapping;
+
+// Mappings by the data pointer of their ArrayBuffer.
+static std::unordered_map<void*, Mapping*> mappings;
+
+// Owns an mmap()ed region exposed to JS as an ArrayBuffer. The ArrayBuffer is
+// released by unmap() or when it is garbage collected, whichever comes first,
+// and the region is unmapped once it is released and no external string
+// points into it anymore.
+class Mapping {
+ public:
+  Mapping(Isolate* isolate,
+          Local<ArrayBuffer> buffer,
+          void* base,
+          size_t size,
+          char* data,
+          size_t length)
+    : isolate_(isolate), base_(base), size_(size), data_(data), length_(length) {
+    handle_.Reset(isolate, buffer);
+    handle_.SetWeak(this, OnCollected, v8::WeakCallbackType::kParameter);
+    isolate_->AdjustAmountOfExternalAllocatedMemory(length_);
+    mappings[data_] = this;
+  }
+
+  ~Mapping() {
+    munmap(base_, size_);
+    isolate_->AdjustAmountOfExternalAllocatedMemory(-static_cast<int64_t>(length_));
+  }
+
+  static Mapping* From(Local<ArrayBuffer> buffer) {
+    auto it = mappings.find(buffer->GetContents().Data());
+    return it == mappings.end() ? nullptr : it->second;
+  }
+
+  // Detaches the ArrayBuffer first so JS can never touch the region again.
+  void Unmap() {
+    handle_.Get(isolate_)->Neuter();
+    Release();
+  }
+
+  void Ref() { refs_ += 1; }
+
+  void Unref() {
+    refs_ -= 1;
+    if (refs_ == 0 && handle_.IsEmpty()) {
+      delete this;
+    }
+  }
+
+  char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+  int Advise(int advice) {
+    return madvise(base_, size_, advice) == 0 ? 0 : -errno;
+  }
+
+ private:
+  static void OnCollected(const v8::WeakCallbackInfo<Mapping>& info) {
+    info.GetParameter()->Release();
+  }
+
+  void Release() {
+    mappings.erase(data_);
+    handle_.Reset();
+    if (refs_ == 0) {
+      delete this;
+    }
+  }
+
+  Isolate* isolate_;
+  Global<ArrayBuffer> handle_;
+  void* base_;     // page aligned start of the mapping
+  size_t size_;    // size of the mapping from base_
+  char* data_;     // start of the ArrayBuffer, within the mapping
+  size_t length_;  // bytes visible to JS
+  int refs_ = 0;   // external strings pointing into the region
+};
+
+// A string whose characters are read straight from a mapping. V8 disposes of
+// the resource when the string is collected.
+template <typename Base, typename Char>
+class MappedString : public Base {
+ public:
+  MappedString(Mapping* mapping, const Char* data, size_t length)
+    : mapping_(mapping), data_(data), length_(length) {
+    mapping_->Ref();
+  }
+
+  ~MappedString() override {
+    mapping_->Unref();
+  }
+
+  const Char* data() const override { return data_; }
+  size_t length() const override { return length_; }
+
+ private:
+  Mapping* mapping_;
+  const Char* data_;
+  size_t length_;
+};
+
+using MappedOneByteString = MappedString<String::ExternalOneByteStringResource, char>;
+using MappedTwoByteString = MappedString<String::ExternalStringResource, uint16_t>;
+
+static void ThrowError(Isolate* isolate, const char* type, int err) {
+  std::string e = type;
+  e += ": ";
+  e += uv_strerror(err);
+  Local<Object> v = v8::Exception::Error(ZERO_STRING(isolate, e.c_str())).As<Object>();
+  USE(v->Set(v->CreationContext(), ZERO_STRING(isolate, "code"), Number::New(isolate, err)));
+  isolate->ThrowException(v);
+}
+
+// map(fd, offset, length, writable) returns an ArrayBuffer over the given
+// range of the file. Read-only mappings are private copy-on-write mappings,
+// so stray writes from JS never fault and never reach the file.
+static void Map(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+  int fd = args[0]->Int32Value(context).FromJust();
+  int64_t offset = args[1]->IntegerValue(context).FromJust();
+  int64_t length = args[2]->IntegerValue(context).FromJust();
+  bool writable = args[3]->IsTrue();
+
+  if (length == 0) {
+    args.GetReturnValue().Set(ArrayBuffer::New(isolate, 0));
+    return;
+  }
+
+  // mmap offsets have to be page aligned, so map from the page containing
+  // |offset| and point the ArrayBuffer into it.
+  static const int64_t page_size = sysconf(_SC_PAGESIZE);
+  int64_t delta = offset % page_size;
+  size_t size = length + delta;
+
+  void* base = ::mmap(nullptr, size,
+                      PROT_READ | PROT_WRITE,
+                      writable ? MAP_SHARED : MAP_PRIVATE,
+                      fd, offset - delta);
+  if (base == MAP_FAILED) {
+    ThrowError(isolate, "map", -errno);
+    return;
+  }
+
+  char* data = static_cast<char*>(base) + delta;
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, data, length);
+  new Mapping(isolate, buffer, base, size, data, length);
+
+  args.GetReturnValue().Set(buffer);
+}
+
+static void Unmap(const FunctionCallbackInfo<Value>& args) {
+  Mapping* mapping = Mapping::From(args[0].As<ArrayBuffer>());
+  if (mapping == nullptr) {
+    args.GetReturnValue().Set(false);
+    return;
+  }
+  mapping->Unmap();
+  args.GetReturnValue().Set(true);
+}
+
+static void Advise(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+
+  Mapping* mapping = Mapping::From(args[0].As<ArrayBuffer>());
+  if (mapping == nullptr) {
+    ZERO_THROW_EXCEPTION(isolate, "buffer is not mapped");
+    return;
+  }
+  int err = mapping->Advise(args[1]->Int32Value(context).FromJust());
+  if (err < 0) {
+    ThrowError(isolate, "advise", err);
+  }
+}
+
+// externalString(buffer, offset, length, twoByte) returns a string over
+// |length| bytes of a mapping without copying them. One-byte strings must be
+// Latin-1, two-byte strings UTF-16 in the byte order of the machine. The
+// mapping stays alive for as long as the string does, even after unmap().
+static void ExternalString(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+
+  Mapping* mapping = Mapping::From(args[0].As<ArrayBuffer>());
+  if (mapping == nullptr) {
+    ZERO_THROW_EXCEPTION(isolate, "buffer is not mapped");
+    return;
+  }
+  int64_t offset = args[1]->IntegerValue(context).FromJust();
+  int64_t length = args[2]->IntegerValue(context).FromJust();
+  bool two_byte = args[3]->IsTrue();
+
+  if (offset < 0 || length < 0 ||
+      static_cast<uint64_t>(offset + length) > mapping->length()) {
+    ZERO_THROW_EXCEPTION(isolate, "string must lie within the mapping");
+    return;
+  }
+  if (length == 0) {
+    args.GetReturnValue().Set(String::Empty(isolate));
+    return;
+  }
+
+  char* data = mapping->data() + offset;
+  Local<String> string;
+  if (two_byte) {
+    if (reinterpret_cast<uintptr_t>(data) % 2 != 0 || length % 2 != 0) {
+      ZERO_THROW_EXCEPTION(isolate, "two-byte strings must be aligned");
+      return;
+    }
+    auto resource = new MappedTwoByteString(
+        mapping, reinterpret_cast<uint16_t*>(data), length / 2);
+    if (!String::NewExternalTwoByte(isolate, resource).ToLocal(&string)) {
+      delete resource;
+      return;
+    }
+  } else {
+    auto resource = new MappedOneByteString(mapping, data, length);
+    if (!String::NewExternalOneByte(isolate, resource).ToLocal(&string)) {
+      delete resource;
+      return;
+    }
+  }
+  args.GetReturnValue().Set(string);
+}
+
+static void Init(Local<Context> context, Local<Object> target) {
+  ZERO_SET_PROPERTY(context, target, "map", Map);
+  ZERO_SET_PROPERTY(context, target, "unmap", Unmap);
+  ZERO_SET_PROPERTY(context, target, "advise", Advise);
+  ZERO_SET_PROPERTY(context, target, "externalString", ExternalString);
+
+#define V(n) ZERO_SET_PROPERTY(context, target, #n, n);
+  V(MADV_NORMAL)
+  V(MADV_SEQUENTIAL)
+  V(MADV_RANDOM)
+  V(MADV_WILLNEED)
+  V(MADV_DONTNEED)
+#undef V
+}
+
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Map);
+  registry->Register(Unmap);
+  registry->Register(Advise);
+  registry->Register(ExternalString);
+}
+
+}  // namespace mmap
+}  // namespace zero
+
+ZERO_REGISTER_INTERNAL(mmap, zero::mmap::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(mmap, zero::mmap::RegisterExternalReferences);
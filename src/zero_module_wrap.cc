@@ -1,11 +1,17 @@
+#include <string.h>  // memcpy
 #include <algorithm>
+#include <memory>
 #include "zero_module_wrap.h"
+#include "zero_import_scanner.h"
 #include "zero.h"
 
 namespace zero {
 namespace loader {
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::Boolean;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -27,7 +33,9 @@ using v8::ScriptCompiler;
 using v8::ScriptOrigin;
 using v8::String;
 using v8::TryCatch;
+using v8::UnboundModuleScript;
 using v8::UnboundScript;
+using v8::Uint8Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -69,7 +77,7 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
   Local<Object> that = args.This();
 
   const int argc = args.Length();
-  CHECK_EQ(argc, 2);
+  CHECK(argc == 2 || argc == 3);
 
   CHECK(args[0]->IsString());
   Local<String> source_text = args[0].As<String>();
@@ -77,6 +85,16 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[1]->IsString());
   Local<String> url = args[1].As<String>();
 
+  // optional code cache from a previous ModuleWrap#createCachedData()
+  ScriptCompiler::CachedData* cached_data = nullptr;
+  if (argc == 3 && !args[2]->IsUndefined()) {
+    CHECK(args[2]->IsArrayBufferView());
+    Local<ArrayBufferView> view = args[2].As<ArrayBufferView>();
+    uint8_t* data = static_cast<uint8_t*>(view->Buffer()->GetContents().Data());
+    cached_data = new ScriptCompiler::CachedData(
+        data + view->ByteOffset(), view->ByteLength());
+  }
+
   Local<Context> context = that->CreationContext();
 
   Local<Module> module;
@@ -95,11 +113,23 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
                         False(isolate),                       // is WASM
                         True(isolate));                       // is ES6 module
     Context::Scope context_scope(context);
-    ScriptCompiler::Source source(source_text, origin);
-    if (!ScriptCompiler::CompileModule(isolate, &source).ToLocal(&module)) {
+    ScriptCompiler::CompileOptions options = cached_data == nullptr ?
+      ScriptCompiler::kNoCompileOptions :
+      ScriptCompiler::kConsumeCodeCache;
+    // source takes ownership of cached_data
+    ScriptCompiler::Source source(source_text, origin, cached_data);
+    if (!ScriptCompiler::CompileModule(isolate, &source, options).ToLocal(&module)) {
       try_catch.ReThrow();
       return;
     }
+
+    if (cached_data != nullptr) {
+      Local<Value> rejected = Boolean::New(isolate, source.GetCachedData()->rejected);
+      if (!that->Set(context, ZERO_STRING(isolate, "cachedDataRejected"), rejected)
+          .FromMaybe(false)) {
+        return;
+      }
+    }
   }
 
   if (!that->Set(context, ZERO_STRING(isolate, "url"), url).FromMaybe(false)) {
@@ -109,6 +139,10 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
 
   ModuleWrap* obj = new ModuleWrap(isolate, that, module);
   obj->context_.Reset(isolate, context);
+  // The unbound script can only be retrieved before the module is
+  // evaluated, but the cache is created afterwards so that it includes the
+  // functions that were compiled lazily while running.
+  obj->unbound_module_script_.Reset(isolate, module->GetUnboundModuleScript());
 
   module_to_module_wrap_map.emplace(module->GetIdentityHash(), obj);
 
@@ -261,6 +295,25 @@ void ModuleWrap::GetError(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(module->GetException());
 }
 
+void ModuleWrap::CreateCachedData(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  ModuleWrap* obj;
+  ASSIGN_OR_RETURN_UNWRAP(&obj, args.This());
+
+  Local<UnboundModuleScript> unbound_module_script =
+      obj->unbound_module_script_.Get(isolate);
+
+  std::unique_ptr<ScriptCompiler::CachedData> cached_data(
+      ScriptCompiler::CreateCodeCache(unbound_module_script));
+  if (!cached_data) {
+    return;
+  }
+
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, cached_data->length);
+  memcpy(buffer->GetContents().Data(), cached_data->data, cached_data->length);
+  args.GetReturnValue().Set(Uint8Array::New(buffer, 0, cached_data->length));
+}
+
 MaybeLocal<Module> ModuleWrap::ResolveCallback(Local<Context> context,
                                                Local<String> specifier,
                                                Local<Module> referrer) {
@@ -372,6 +425,24 @@ void ModuleWrap::SetInitializeImportMetaObjectCallback(
       HostInitializeImportMetaObjectCallback);
 }
 
+// scanImports(view) returns the specifiers a module's UTF-8 source imports
+// statically, found without compiling it. See ScanImports.
+static void ScanModuleImports(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<ArrayBufferView> view = args[0].As<ArrayBufferView>();
+
+  const char* data =
+      static_cast<const char*>(view->Buffer()->GetContents().Data()) + view->ByteOffset();
+  std::vector<std::string> found = ScanImports(data, view->ByteLength());
+
+  Local<Array> specifiers = Array::New(isolate, found.size());
+  for (size_t i = 0; i < found.size(); i += 1) {
+    USE(specifiers->Set(context, i, ZERO_STRING(isolate, found[i].c_str())));
+  }
+  args.GetReturnValue().Set(specifiers);
+}
+
 void ModuleWrap::Initialize(Local<Context> context, Local<Object> target) {
   Isolate* isolate = context->GetIsolate();
 
@@ -385,6 +456,7 @@ void ModuleWrap::Initialize(Local<Context> context, Local<Object> target) {
   ZERO_SET_PROTO_PROP(context, tpl, "getError", GetError);
   ZERO_SET_PROTO_PROP(context, tpl, "getStaticDependencySpecifiers",
                       GetStaticDependencySpecifiers);
+  ZERO_SET_PROTO_PROP(context, tpl, "createCachedData", CreateCachedData);
 
   target->Set(ZERO_STRING(isolate, "ModuleWrap"), tpl->GetFunction());
   ZERO_SET_PROPERTY(context, target,
@@ -393,6 +465,7 @@ void ModuleWrap::Initialize(Local<Context> context, Local<Object> target) {
   ZERO_SET_PROPERTY(context, target,
                     "setInitializeImportMetaObjectCallback",
                     ModuleWrap::SetInitializeImportMetaObjectCallback);
+  ZERO_SET_PROPERTY(context, target, "scanImports", ScanModuleImports);
 
 #define V(name) \
   ZERO_SET_PROPERTY(context, target, #name, v8::Module::name);
@@ -405,7 +478,24 @@ void ModuleWrap::Initialize(Local<Context> context, Local<Object> target) {
 #undef V
 }
 
+void ModuleWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Link);
+  registry->Register(Instantiate);
+  registry->Register(Evaluate);
+  registry->Register(GetNamespace);
+  registry->Register(GetStatus);
+  registry->Register(GetError);
+  registry->Register(GetStaticDependencySpecifiers);
+  registry->Register(CreateCachedData);
+  registry->Register(SetImportModuleDynamicallyCallback);
+  registry->Register(SetInitializeImportMetaObjectCallback);
+  registry->Register(ScanModuleImports);
+}
+
 }  // namespace loader
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(module_wrap, zero::loader::ModuleWrap::Initialize);
+ZERO_REGISTER_EXTERNAL_REFERENCES(module_wrap,
+                                  zero::loader::ModuleWrap::RegisterExternalReferences);
@@ -13,6 +13,7 @@ class ModuleWrap : public BaseObject {
  public:
   static void Initialize(v8::Local<v8::Context> context,
                          v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
   static void HostInitializeImportMetaObjectCallback(
       v8::Local<v8::Context> context,
       v8::Local<v8::Module> module,
@@ -33,6 +34,7 @@ class ModuleWrap : public BaseObject {
   static void GetError(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetStaticDependencySpecifiers(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void CreateCachedData(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void Resolve(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetImportModuleDynamicallyCallback(
@@ -53,6 +55,7 @@ class ModuleWrap : public BaseObject {
   static v8::Persistent<v8::Function> host_import_module_dynamically_callback;
 
   v8::Persistent<v8::Module> module_;
+  v8::Persistent<v8::UnboundModuleScript> unbound_module_script_;
   bool linked_ = false;
   std::unordered_map<std::string, v8::Persistent<v8::Promise>> resolve_cache_;
   v8::Persistent<v8::Context> context_;
@@ -0,0 +1,97 @@
+#ifndef SRC_ZERO_MPSC_QUEUE_H_
+#define SRC_ZERO_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>  // std::move
+
+namespace zero {
+
+// Unbounded lock-free queue with any number of producers and a single
+// consumer, after Dmitry Vyukov's intrusive MPSC node-based queue.
+//
+// Push never blocks. Pop may briefly report the queue as empty while a
+// producer is halfway through a Push; callers that need to see every item
+// must arrange to be woken up again after each Push (see
+// PerIsolatePlatformData::ScheduleFlush).
+template <class T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  ~MpscQueue() {
+    while (Pop()) {}
+  }
+
+  // Thread-safe.
+  void Push(std::unique_ptr<T> value) {
+    Push(new Node(std::move(value)));
+  }
+
+  // Must only be called from the consumer thread.
+  std::unique_ptr<T> Pop() {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+      tail_ = next;
+      return Take(tail);
+    }
+
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // a producer has swapped head_ but not linked its node yet
+      return nullptr;
+    }
+
+    Push(&stub_);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return Take(tail);
+    }
+
+    return nullptr;
+  }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    explicit Node(std::unique_ptr<T> v) : value(std::move(v)), next(nullptr) {}
+
+    std::unique_ptr<T> value;
+    std::atomic<Node*> next;
+  };
+
+  void Push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  static std::unique_ptr<T> Take(Node* node) {
+    std::unique_ptr<T> value = std::move(node->value);
+    delete node;
+    return value;
+  }
+
+  Node stub_;
+  std::atomic<Node*> head_;
+  Node* tail_;  // only touched by the consumer
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+};
+
+}  // namespace zero
+
+#endif  // SRC_ZERO_MPSC_QUEUE_H_
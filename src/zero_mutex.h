@@ -64,6 +64,8 @@ class ConditionVariableBase {
   inline void Broadcast(const ScopedLock&);
   inline void Signal(const ScopedLock&);
   inline void Wait(const ScopedLock& scoped_lock);
+  // Returns false if the timeout (in nanoseconds) expired.
+  inline bool TimedWait(const ScopedLock& scoped_lock, uint64_t timeout);
 
  private:
   typename Traits::CondT cond_;
@@ -98,6 +100,10 @@ struct LibuvMutexTraits {
     uv_cond_wait(cond, mutex);
   }
 
+  static inline int cond_timedwait(CondT* cond, MutexT* mutex, uint64_t timeout) {
+    return uv_cond_timedwait(cond, mutex, timeout);
+  }
+
   static inline void mutex_destroy(MutexT* mutex) {
     uv_mutex_destroy(mutex);
   }
@@ -136,6 +142,12 @@ void ConditionVariableBase<Traits>::Wait(const ScopedLock& scoped_lock) {
   Traits::cond_wait(&cond_, &scoped_lock.mutex_.mutex_);
 }
 
+template <typename Traits>
+bool ConditionVariableBase<Traits>::TimedWait(const ScopedLock& scoped_lock,
+                                              uint64_t timeout) {
+  return Traits::cond_timedwait(&cond_, &scoped_lock.mutex_.mutex_, timeout) == 0;
+}
+
 template <typename Traits>
 MutexBase<Traits>::MutexBase() {
   CHECK_EQ(0, Traits::mutex_init(&mutex_));
@@ -1,8 +1,11 @@
 #include <uv.h>
+#include <memory>
 
 #include "v8.h"
 #include "zero.h"
+#include "zero_platform.h"
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::Context;
 using v8::FunctionCallbackInfo;
@@ -15,7 +18,9 @@ using v8::Value;
 namespace zero {
 namespace performance {
 
-uint64_t timeOrigin = 0;
+// Initialized when the binary is loaded rather than in Init(), which only runs
+// once when the bindings are captured in the startup snapshot.
+uint64_t timeOrigin = uv_hrtime();
 static const double NS_PER_MS = 1000000;
 
 static void Now(const FunctionCallbackInfo<Value>& args) {
@@ -30,14 +35,48 @@ static void Now(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(v8::Number::New(isolate, now));
 }
 
-void Init(Local<Context> context, Local<Object> target) {
-  timeOrigin = uv_hrtime();
+static void TimeOrigin(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  double origin = static_cast<double>(timeOrigin) / NS_PER_MS;
+
+  args.GetReturnValue().Set(v8::Number::New(isolate, origin));
+}
+
+// Returns one { tasksRun, steals, idleTime } object per V8 worker thread, with
+// idleTime in milliseconds.
+static void GetWorkerStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
 
+  int count = platform->NumberOfWorkerThreads();
+  Local<Array> result = Array::New(isolate, count);
+  for (int i = 0; i < count; i += 1) {
+    const WorkerStats& stats = platform->GetWorkerStats(i);
+    Local<Object> entry = Object::New(isolate);
+    ZERO_SET_PROPERTY(context, entry, "tasksRun", static_cast<double>(stats.tasks_run));
+    ZERO_SET_PROPERTY(context, entry, "steals", static_cast<double>(stats.steals));
+    ZERO_SET_PROPERTY(context, entry, "idleTime", stats.idle_time / NS_PER_MS);
+    USE(result->Set(context, i, entry));
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+void Init(Local<Context> context, Local<Object> target) {
   ZERO_SET_PROPERTY(context, target, "now", Now);
-  ZERO_SET_PROPERTY(context, target, "timeOrigin", static_cast<double>(timeOrigin) / NS_PER_MS);
+  ZERO_SET_PROPERTY(context, target, "timeOrigin", TimeOrigin);
+  ZERO_SET_PROPERTY(context, target, "getWorkerStats", GetWorkerStats);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Now);
+  registry->Register(TimeOrigin);
+  registry->Register(GetWorkerStats);
 }
 
 }  // namespace performance
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(performance, zero::performance::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(performance, zero::performance::RegisterExternalReferences);
@@ -8,6 +8,9 @@
 
 namespace zero {
 
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
@@ -15,75 +18,330 @@ using v8::Object;
 using v8::Platform;
 using v8::Task;
 using v8::TracingController;
+using v8::Value;
+
+ZeroPlatform* platform = nullptr;
 
 namespace {
 
-static void WorkerThreadMain(void* data) {
-  TaskQueue<Task>* pending_worker_tasks = static_cast<TaskQueue<Task>*>(data);
-  while (std::unique_ptr<Task> task = pending_worker_tasks->BlockingPop()) {
-    task->Run();
-    pending_worker_tasks->NotifyOfCompletion();
+// The worker that the current thread belongs to, if any.
+thread_local void* current_worker = nullptr;
+
+}  // namespace
+
+DelayedTaskScheduler::DelayedTaskScheduler(v8::TaskRunner* runner)
+    : runner_(runner) {}
+
+void DelayedTaskScheduler::Start() {
+  CHECK_EQ(0, uv_thread_create(&thread_, SchedulerMain, this));
+  started_ = true;
+}
+
+void DelayedTaskScheduler::SchedulerMain(void* data) {
+  DelayedTaskScheduler* scheduler = static_cast<DelayedTaskScheduler*>(data);
+  std::vector<ScheduledTask>& heap = scheduler->heap_;
+
+  Mutex::ScopedLock scoped_lock(scheduler->lock_);
+  while (!scheduler->stopped_) {
+    if (heap.empty()) {
+      scheduler->changed_.Wait(scoped_lock);
+      continue;
+    }
+
+    uint64_t now = uv_hrtime();
+    if (heap.front().due > now) {
+      scheduler->changed_.TimedWait(scoped_lock, heap.front().due - now);
+      continue;
+    }
+
+    std::pop_heap(heap.begin(), heap.end(), Later);
+    std::unique_ptr<Task> task = std::move(heap.back().task);
+    heap.pop_back();
+
+    Mutex::ScopedUnlock scoped_unlock(scoped_lock);
+    scheduler->runner_->PostTask(std::move(task));
   }
 }
 
-}  // namespace
+void DelayedTaskScheduler::PostDelayedTask(std::unique_ptr<Task> task,
+                                           double delay_in_seconds) {
+  uint64_t delay = static_cast<uint64_t>(std::max(delay_in_seconds, 0.0) * 1e9);
+
+  Task* raw = task.get();
 
-WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
+  Mutex::ScopedLock scoped_lock(lock_);
+  if (stopped_) {
+    return;
+  }
+  heap_.push_back({ uv_hrtime() + delay, next_sequence_++, std::move(task) });
+  std::push_heap(heap_.begin(), heap_.end(), Later);
+  // only the earliest task decides how long the scheduler sleeps
+  if (heap_.front().task.get() == raw) {
+    changed_.Signal(scoped_lock);
+  }
+}
+
+void DelayedTaskScheduler::Stop() {
+  {
+    Mutex::ScopedLock scoped_lock(lock_);
+    stopped_ = true;
+    heap_.clear();
+    changed_.Signal(scoped_lock);
+  }
+  if (started_) {
+    CHECK_EQ(0, uv_thread_join(&thread_));
+    started_ = false;
+  }
+}
+
+WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size)
+    : delayed_task_scheduler_(this) {
   for (int i = 0; i < thread_pool_size; i++) {
-    std::unique_ptr<uv_thread_t> t { new uv_thread_t() };
-    if (uv_thread_create(t.get(), WorkerThreadMain,
-          &pending_worker_tasks_) != 0) {
+    std::unique_ptr<Worker> worker { new Worker() };
+    worker->runner = this;
+    if (uv_thread_create(&worker->thread, WorkerMain, worker.get()) != 0) {
       break;
     }
-    threads_.push_back(std::move(t));
+    workers_.push_back(std::move(worker));
+  }
+  CHECK(!workers_.empty());
+
+  delayed_task_scheduler_.Start();
+}
+
+void WorkerThreadsTaskRunner::WorkerMain(void* data) {
+  Worker* worker = static_cast<Worker*>(data);
+  WorkerThreadsTaskRunner* runner = worker->runner;
+  current_worker = worker;
+
+  for (;;) {
+    std::unique_ptr<Task> task = runner->PopTask(worker);
+    if (!task) {
+      runner->WaitForTasks(worker);
+      {
+        Mutex::ScopedLock scoped_lock(runner->lock_);
+        if (runner->stopped_) {
+          return;
+        }
+      }
+      continue;
+    }
+
+    task->Run();
+    worker->stats.tasks_run++;
+    runner->NotifyOfCompletion();
+  }
+}
+
+std::unique_ptr<Task> WorkerThreadsTaskRunner::PopTask(Worker* worker) {
+  {
+    Mutex::ScopedLock scoped_lock(worker->lock);
+    if (!worker->tasks.empty()) {
+      std::unique_ptr<Task> task = std::move(worker->tasks.back());
+      worker->tasks.pop_back();
+      queued_tasks_--;
+      return task;
+    }
+  }
+
+  if (queued_tasks_ == 0) {
+    return nullptr;
+  }
+
+  size_t count = workers_.size();
+  size_t start = 0;
+  while (workers_[start].get() != worker) {
+    start++;
+  }
+  for (size_t i = 1; i < count; i++) {
+    Worker* victim = workers_[(start + i) % count].get();
+    Mutex::ScopedLock scoped_lock(victim->lock);
+    if (!victim->tasks.empty()) {
+      std::unique_ptr<Task> task = std::move(victim->tasks.front());
+      victim->tasks.pop_front();
+      queued_tasks_--;
+      worker->stats.steals++;
+      return task;
+    }
+  }
+
+  return nullptr;
+}
+
+void WorkerThreadsTaskRunner::WaitForTasks(Worker* worker) {
+  Mutex::ScopedLock scoped_lock(lock_);
+  // PostTask increments queued_tasks_ before it looks at sleeping_workers_,
+  // and this does the opposite, so one of them always sees the other.
+  sleeping_workers_++;
+  uint64_t start = uv_hrtime();
+  while (queued_tasks_ == 0 && !stopped_) {
+    tasks_available_.Wait(scoped_lock);
+  }
+  worker->stats.idle_time += uv_hrtime() - start;
+  sleeping_workers_--;
+}
+
+void WorkerThreadsTaskRunner::NotifyOfCompletion() {
+  if (--outstanding_tasks_ == 0) {
+    Mutex::ScopedLock scoped_lock(lock_);
+    tasks_drained_.Broadcast(scoped_lock);
   }
 }
 
 void WorkerThreadsTaskRunner::PostTask(std::unique_ptr<Task> task) {
-  pending_worker_tasks_.Push(std::move(task));
+  Worker* worker = static_cast<Worker*>(current_worker);
+  if (worker == nullptr || worker->runner != this) {
+    worker = workers_[next_worker_++ % workers_.size()].get();
+  }
+
+  outstanding_tasks_++;
+  {
+    Mutex::ScopedLock scoped_lock(worker->lock);
+    worker->tasks.push_back(std::move(task));
+  }
+  queued_tasks_++;
+
+  if (sleeping_workers_ > 0) {
+    Mutex::ScopedLock scoped_lock(lock_);
+    tasks_available_.Signal(scoped_lock);
+  }
 }
 
 void WorkerThreadsTaskRunner::PostDelayedTask(
     std::unique_ptr<v8::Task> task, double delay_in_seconds) {
-  UNREACHABLE();
+  delayed_task_scheduler_.PostDelayedTask(std::move(task), delay_in_seconds);
 }
 
 void WorkerThreadsTaskRunner::BlockingDrain() {
-  pending_worker_tasks_.BlockingDrain();
+  Mutex::ScopedLock scoped_lock(lock_);
+  while (outstanding_tasks_ > 0) {
+    tasks_drained_.Wait(scoped_lock);
+  }
 }
 
 void WorkerThreadsTaskRunner::Shutdown() {
-  pending_worker_tasks_.Stop();
-  for (size_t i = 0; i < threads_.size(); i++) {
-    CHECK_EQ(0, uv_thread_join(threads_[i].get()));
+  // Stop the scheduler first so that it doesn't hand out tasks to workers
+  // that have already exited.
+  delayed_task_scheduler_.Stop();
+
+  {
+    Mutex::ScopedLock scoped_lock(lock_);
+    stopped_ = true;
+    tasks_available_.Broadcast(scoped_lock);
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
+    CHECK_EQ(0, uv_thread_join(&workers_[i]->thread));
   }
 }
 
 int WorkerThreadsTaskRunner::NumberOfWorkerThreads() {
-  return threads_.size();
+  return workers_.size();
+}
+
+const WorkerStats& WorkerThreadsTaskRunner::GetWorkerStats(int index) {
+  return workers_[index]->stats;
 }
 
 PerIsolatePlatformData::PerIsolatePlatformData(
     v8::Isolate* isolate, uv_loop_t* loop)
-  : isolate_(isolate), loop_(loop) {
+  : isolate_(isolate), loop_(loop), loop_thread_(uv_thread_self()) {
   flush_tasks_ = new uv_async_t();
   CHECK_EQ(0, uv_async_init(loop, flush_tasks_, FlushTasks));
   flush_tasks_->data = static_cast<void*>(this);
   uv_unref(reinterpret_cast<uv_handle_t*>(flush_tasks_));
+
+  idle_prepare_ = new uv_prepare_t();
+  CHECK_EQ(0, uv_prepare_init(loop, idle_prepare_));
+  idle_prepare_->data = static_cast<void*>(this);
+  uv_unref(reinterpret_cast<uv_handle_t*>(idle_prepare_));
+}
+
+void PerIsolatePlatformData::ScheduleFlush() {
+  // A burst of posts from many threads results in a single uv_async_send.
+  // The flag is cleared right before the loop starts flushing, so anything
+  // pushed after that point schedules another flush.
+  if (flush_pending_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  Mutex::ScopedLock lock(flush_tasks_mutex_);
+  if (flush_tasks_ != nullptr) {
+    uv_async_send(flush_tasks_);
+  }
 }
 
 void PerIsolatePlatformData::FlushTasks(uv_async_t* handle) {
   auto platform_data = static_cast<PerIsolatePlatformData*>(handle->data);
+  platform_data->flush_pending_.exchange(false, std::memory_order_acq_rel);
   platform_data->FlushForegroundTasksInternal();
+
+  // Let the loop exit again once every background task has finished.
+  if (platform_data->flush_tasks_referenced_ &&
+      platform_data->outstanding_worker_tasks_ == 0) {
+    uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+    platform_data->flush_tasks_referenced_ = false;
+  }
+}
+
+void PerIsolatePlatformData::WorkerTaskPosted() {
+  outstanding_worker_tasks_++;
+  // Tasks posted from worker threads are always posted by another task of
+  // this isolate, which already holds the reference.
+  uv_thread_t self = uv_thread_self();
+  if (uv_thread_equal(&self, &loop_thread_) && !flush_tasks_referenced_) {
+    uv_ref(reinterpret_cast<uv_handle_t*>(flush_tasks_));
+    flush_tasks_referenced_ = true;
+  }
+}
+
+void PerIsolatePlatformData::WorkerTaskFinished() {
+  if (--outstanding_worker_tasks_ == 0) {
+    ScheduleFlush();
+  }
 }
 
 void PerIsolatePlatformData::PostIdleTask(std::unique_ptr<v8::IdleTask> task) {
-  UNREACHABLE();
+  // V8 only posts idle tasks from the isolate's own thread.
+  idle_tasks_.Push(std::move(task));
+  uv_prepare_start(idle_prepare_, RunIdleTasks);
+}
+
+// Idle time is capped so that a long running idle task doesn't delay
+// I/O that arrives while the loop would otherwise be blocked.
+static const int kMaxIdleTimeMs = 50;
+
+void PerIsolatePlatformData::RunIdleTasks(uv_prepare_t* handle) {
+  auto platform_data = static_cast<PerIsolatePlatformData*>(handle->data);
+
+  // How long the loop is about to block: 0 if there is more work ready,
+  // -1 if nothing but I/O can wake it up, otherwise the next timer.
+  int timeout = uv_backend_timeout(platform_data->loop_);
+  if (timeout == 0) {
+    return;
+  }
+  if (timeout < 0 || timeout > kMaxIdleTimeMs) {
+    timeout = kMaxIdleTimeMs;
+  }
+
+  double deadline = platform->MonotonicallyIncreasingTime() + timeout / 1e3;
+
+  Isolate* isolate = platform_data->isolate_;
+  HandleScope scope(isolate);
+  InternalCallbackScope callback_scope(isolate);
+
+  while (platform->MonotonicallyIncreasingTime() < deadline) {
+    std::unique_ptr<v8::IdleTask> task = platform_data->idle_tasks_.Pop();
+    if (!task) {
+      uv_prepare_stop(handle);
+      return;
+    }
+    task->Run(deadline);
+    platform_data->idle_tasks_.NotifyOfCompletion();
+  }
 }
 
 void PerIsolatePlatformData::PostTask(std::unique_ptr<Task> task) {
   foreground_tasks_.Push(std::move(task));
-  uv_async_send(flush_tasks_);
+  ScheduleFlush();
 }
 
 void PerIsolatePlatformData::PostDelayedTask(
@@ -93,17 +351,41 @@ void PerIsolatePlatformData::PostDelayedTask(
   delayed->platform_data = shared_from_this();
   delayed->timeout = delay_in_seconds;
   foreground_delayed_tasks_.Push(std::move(delayed));
-  uv_async_send(flush_tasks_);
+  ScheduleFlush();
 }
 
 PerIsolatePlatformData::~PerIsolatePlatformData() {
-  while (FlushForegroundTasksInternal()) {}
+  CHECK_EQ(flush_tasks_, nullptr);
+}
+
+void PerIsolatePlatformData::Shutdown() {
+  if (flush_tasks_ == nullptr) {
+    return;
+  }
+
+  // Whatever is still queued is dropped without running. The embedder runs
+  // the last tasks with DrainTasks() while the isolate is still entered.
+  while (foreground_tasks_.Pop()) {}
+  while (foreground_delayed_tasks_.Pop()) {}
+  while (idle_tasks_.Pop()) {}
   CancelPendingDelayedTasks();
 
-  uv_close(reinterpret_cast<uv_handle_t*>(flush_tasks_),
+  uv_async_t* flush_tasks;
+  {
+    Mutex::ScopedLock lock(flush_tasks_mutex_);
+    flush_tasks = flush_tasks_;
+    flush_tasks_ = nullptr;
+  }
+
+  // The handles are freed once the loop runs their close callbacks.
+  uv_close(reinterpret_cast<uv_handle_t*>(flush_tasks),
            [](uv_handle_t* handle) {
     delete reinterpret_cast<uv_async_t*>(handle);
   });
+  uv_close(reinterpret_cast<uv_handle_t*>(idle_prepare_),
+           [](uv_handle_t* handle) {
+    delete reinterpret_cast<uv_prepare_t*>(handle);
+  });
 }
 
 void PerIsolatePlatformData::ref() {
@@ -132,20 +414,31 @@ void ZeroPlatform::RegisterIsolate(Isolate* isolate, uv_loop_t* loop) {
 }
 
 void ZeroPlatform::UnregisterIsolate(Isolate* isolate) {
-  Mutex::ScopedLock lock(per_isolate_mutex_);
-  std::shared_ptr<PerIsolatePlatformData> existing = per_isolate_[isolate];
-  CHECK(existing);
-  if (existing->unref() == 0) {
-    per_isolate_.erase(isolate);
+  std::shared_ptr<PerIsolatePlatformData> existing;
+  {
+    Mutex::ScopedLock lock(per_isolate_mutex_);
+    auto it = per_isolate_.find(isolate);
+    CHECK_NE(it, per_isolate_.end());
+    if (it->second->unref() > 0) {
+      return;
+    }
+    existing = it->second;
+    per_isolate_.erase(it);
   }
+  // Outside of the lock, as destroying tasks may post new ones.
+  existing->Shutdown();
 }
 
 void ZeroPlatform::Shutdown() {
   worker_thread_task_runner_->Shutdown();
 
+  std::unordered_map<Isolate*, std::shared_ptr<PerIsolatePlatformData>> per_isolate;
   {
     Mutex::ScopedLock lock(per_isolate_mutex_);
-    per_isolate_.clear();
+    per_isolate.swap(per_isolate_);
+  }
+  for (auto& entry : per_isolate) {
+    entry.second->Shutdown();
   }
 }
 
@@ -153,6 +446,21 @@ int ZeroPlatform::NumberOfWorkerThreads() {
   return worker_thread_task_runner_->NumberOfWorkerThreads();
 }
 
+const WorkerStats& ZeroPlatform::GetWorkerStats(int index) {
+  return worker_thread_task_runner_->GetWorkerStats(index);
+}
+
+int ZeroPlatform::DefaultThreadPoolSize() {
+  uv_cpu_info_t* cpu_infos;
+  int count;
+  if (uv_cpu_info(&cpu_infos, &count) != 0) {
+    return 4;
+  }
+  uv_free_cpu_info(cpu_infos, count);
+  // leave a core for the main thread
+  return count > 1 ? count - 1 : 1;
+}
+
 void PerIsolatePlatformData::RunForegroundTask(std::unique_ptr<Task> task) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -180,16 +488,15 @@ void PerIsolatePlatformData::CancelPendingDelayedTasks() {
   scheduled_delayed_tasks_.clear();
 }
 
+// Background tasks of this isolate keep its loop alive on their own (see
+// WorkerTaskPosted), so this only has to run what is already queued and
+// never waits on the worker pool.
 void ZeroPlatform::DrainTasks(Isolate* isolate) {
   std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
-
-  do {
-    // Right now, there is no way to drain only background tasks associated
-    // with a specific isolate, so this sometimes does more work than
-    // necessary. In the long run, that functionality is probably going to
-    // be available anyway, though.
-    worker_thread_task_runner_->BlockingDrain();
-  } while (per_isolate->FlushForegroundTasksInternal());
+  if (!per_isolate) {
+    return;
+  }
+  while (per_isolate->FlushForegroundTasksInternal()) {}
 }
 
 bool PerIsolatePlatformData::FlushForegroundTasksInternal() {
@@ -214,7 +521,12 @@ bool PerIsolatePlatformData::FlushForegroundTasksInternal() {
     });
   }
 
-  std::queue<std::unique_ptr<Task>> tasks = foreground_tasks_.PopAll();
+  // Only run the tasks that are queued right now. Tasks posted while these
+  // run are picked up by the next flush.
+  std::queue<std::unique_ptr<Task>> tasks;
+  while (std::unique_ptr<Task> task = foreground_tasks_.Pop()) {
+    tasks.push(std::move(task));
+  }
   while (!tasks.empty()) {
     std::unique_ptr<Task> task = std::move(tasks.front());
     tasks.pop();
@@ -224,39 +536,108 @@ bool PerIsolatePlatformData::FlushForegroundTasksInternal() {
   return did_work;
 }
 
+namespace {
+
+// The isolate on whose behalf the current worker thread is running a task.
+thread_local PerIsolatePlatformData* current_owner = nullptr;
+
+// Wraps a background task to track it as outstanding work of the isolate
+// that posted it.
+class OwnedTask : public Task {
+ public:
+  OwnedTask(std::unique_ptr<Task> task,
+            std::shared_ptr<PerIsolatePlatformData> owner)
+    : task_(std::move(task)), owner_(std::move(owner)) {
+    owner_->WorkerTaskPosted();
+  }
+
+  void Run() override {
+    current_owner = owner_.get();
+    task_->Run();
+    current_owner = nullptr;
+    task_.reset();
+    owner_->WorkerTaskFinished();
+  }
+
+ private:
+  std::unique_ptr<Task> task_;
+  std::shared_ptr<PerIsolatePlatformData> owner_;
+};
+
+}  // namespace
+
 void ZeroPlatform::CallOnWorkerThread(std::unique_ptr<Task> task) {
+  std::shared_ptr<PerIsolatePlatformData> owner;
+  Isolate* isolate = Isolate::GetCurrent();
+  if (isolate != nullptr) {
+    Mutex::ScopedLock lock(per_isolate_mutex_);
+    auto it = per_isolate_.find(isolate);
+    if (it != per_isolate_.end()) {
+      owner = it->second;
+    }
+  } else if (current_owner != nullptr) {
+    owner = current_owner->shared_from_this();
+  }
+
+  if (owner) {
+    task.reset(new OwnedTask(std::move(task), std::move(owner)));
+  }
   worker_thread_task_runner_->PostTask(std::move(task));
 }
 
 std::shared_ptr<PerIsolatePlatformData>
 ZeroPlatform::ForIsolate(Isolate* isolate) {
   Mutex::ScopedLock lock(per_isolate_mutex_);
-  std::shared_ptr<PerIsolatePlatformData> data = per_isolate_[isolate];
-  return data;
+  auto it = per_isolate_.find(isolate);
+  if (it == per_isolate_.end()) {
+    return nullptr;
+  }
+  return it->second;
 }
 
+// Tasks posted to an isolate that was never registered, or that has already
+// been unregistered (e.g. a delayed worker task that fires during shutdown),
+// are dropped.
 void ZeroPlatform::CallOnForegroundThread(Isolate* isolate, Task* task) {
-  ForIsolate(isolate)->PostTask(std::unique_ptr<Task>(task));
+  std::unique_ptr<Task> owned(task);
+  std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
+  if (per_isolate) {
+    per_isolate->PostTask(std::move(owned));
+  }
+}
+
+void ZeroPlatform::CallIdleOnForegroundThread(Isolate* isolate, v8::IdleTask* task) {
+  std::unique_ptr<v8::IdleTask> owned(task);
+  std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
+  if (per_isolate) {
+    per_isolate->PostIdleTask(std::move(owned));
+  }
 }
 
 void ZeroPlatform::CallDelayedOnForegroundThread(
     Isolate* isolate, Task* task, double delay_in_seconds) {
-  ForIsolate(isolate)->PostDelayedTask(std::unique_ptr<Task>(task), delay_in_seconds);
+  std::unique_ptr<Task> owned(task);
+  std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
+  if (per_isolate) {
+    per_isolate->PostDelayedTask(std::move(owned), delay_in_seconds);
+  }
 }
 
 void ZeroPlatform::CallDelayedOnWorkerThread(std::unique_ptr<Task> task,
                                              double delay_in_seconds) {
-  fprintf(stderr, "delayed task queued in %f\n", delay_in_seconds);
-  // ForIsolate(Isolate::GetCurrent())->PostDelayedTask(
-  //   std::move(task), delay_in_seconds);
+  worker_thread_task_runner_->PostDelayedTask(std::move(task), delay_in_seconds);
 }
 
 bool ZeroPlatform::FlushForegroundTasks(v8::Isolate* isolate) {
-  return ForIsolate(isolate)->FlushForegroundTasksInternal();
+  std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
+  return per_isolate && per_isolate->FlushForegroundTasksInternal();
 }
 
 void ZeroPlatform::CancelPendingDelayedTasks(v8::Isolate* isolate) {
-  ForIsolate(isolate)->CancelPendingDelayedTasks();
+  std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
+  if (per_isolate) {
+    per_isolate->CancelPendingDelayedTasks();
+  }
 }
 
 std::shared_ptr<v8::TaskRunner>
@@ -346,4 +727,68 @@ std::queue<std::unique_ptr<T>> TaskQueue<T>::PopAll() {
   return result;
 }
 
+// The `platform` binding is only reachable through the internal binding
+// (zero configured with --expose-binding) and exists for tests.
+namespace platform_binding {
+
+// Posts a task to the V8 worker pool with a delay. When it runs it posts
+// `callback` back to the main thread. This exercises the same path as V8's
+// own delayed background tasks.
+class DelayedWorkerTask : public v8::Task {
+ public:
+  DelayedWorkerTask(Isolate* isolate, Local<Function> callback)
+    : isolate_(isolate), callback_(new v8::Global<Function>(isolate, callback)) {}
+
+  void Run() override {
+    platform->CallOnForegroundThread(isolate_, new CallbackTask(callback_));
+  }
+
+ private:
+  class CallbackTask : public v8::Task {
+   public:
+    explicit CallbackTask(v8::Global<Function>* callback) : callback_(callback) {}
+
+    void Run() override {
+      Isolate* isolate = Isolate::GetCurrent();
+      HandleScope scope(isolate);
+      Local<Context> context = isolate->GetCurrentContext();
+      Local<Function> callback = callback_->Get(isolate);
+      delete callback_;
+      USE(callback->Call(context, v8::Undefined(isolate), 0, nullptr));
+    }
+
+   private:
+    v8::Global<Function>* callback_;
+  };
+
+  Isolate* isolate_;
+  // Deliberately leaked if the task never runs, because by the time pending
+  // delayed tasks are destroyed the isolate may already be gone.
+  v8::Global<Function>* callback_;
+};
+
+static void PostDelayedWorkerTask(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsFunction());
+
+  double delay = args[0].As<v8::Number>()->Value() / 1000;
+  platform->CallDelayedOnWorkerThread(
+      std::unique_ptr<v8::Task>(new DelayedWorkerTask(isolate, args[1].As<Function>())),
+      delay);
+}
+
+void Init(Local<Context> context, Local<Object> target) {
+  ZERO_SET_PROPERTY(context, target, "postDelayedWorkerTask", PostDelayedWorkerTask);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(PostDelayedWorkerTask);
+}
+
+}  // namespace platform_binding
 }  // namespace zero
+
+ZERO_REGISTER_INTERNAL(platform, zero::platform_binding::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(platform, zero::platform_binding::RegisterExternalReferences);
@@ -3,6 +3,8 @@
 
 #include <uv.h>
 
+#include <atomic>
+#include <deque>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -13,6 +15,7 @@
 #include "libplatform/libplatform.h"
 #include "zero.h"
 #include "zero_mutex.h"
+#include "zero_mpsc_queue.h"
 
 namespace zero {
 
@@ -62,8 +65,10 @@ class PerIsolatePlatformData :
   void PostIdleTask(std::unique_ptr<v8::IdleTask> task) override;
   void PostDelayedTask(std::unique_ptr<v8::Task> task,
                        double delay_in_seconds) override;
-  bool IdleTasksEnabled() override { return false; };
+  bool IdleTasksEnabled() override { return true; };
 
+  // Closes the libuv handles. Must be called on the isolate's thread before
+  // the last reference goes away, which may happen on a worker thread.
   void Shutdown();
 
   void ref();
@@ -73,27 +78,97 @@ class PerIsolatePlatformData :
   bool FlushForegroundTasksInternal();
   void CancelPendingDelayedTasks();
 
+  // Background tasks posted on behalf of this isolate keep its loop alive
+  // until they finish, and wake it up through flush_tasks_ when they do.
+  void WorkerTaskPosted();
+  void WorkerTaskFinished();
+
  private:
   void DeleteFromScheduledTasks(DelayedTask* task);
 
+  // Wakes up the loop to flush tasks, unless a wakeup is already pending.
+  void ScheduleFlush();
+
   static void FlushTasks(uv_async_t* handle);
   static void RunForegroundTask(std::unique_ptr<v8::Task> task);
   static void RunForegroundTask(uv_timer_t* timer);
+  static void RunIdleTasks(uv_prepare_t* handle);
 
   int ref_count_ = 1;
   v8::Isolate* isolate_;
   uv_loop_t* const loop_;
+  uv_thread_t loop_thread_;
+  Mutex flush_tasks_mutex_;  // protects flush_tasks_ from worker threads
   uv_async_t* flush_tasks_ = nullptr;
-  TaskQueue<v8::Task> foreground_tasks_;
+  std::atomic<bool> flush_pending_{false};
+  std::atomic<int> outstanding_worker_tasks_{0};
+  bool flush_tasks_referenced_ = false;  // only touched on loop_thread_
+  MpscQueue<v8::Task> foreground_tasks_;
   TaskQueue<DelayedTask> foreground_delayed_tasks_;
 
+  // Idle tasks run from a prepare handle, right before the loop would block
+  // waiting for I/O. The handle is only active while idle tasks are queued.
+  uv_prepare_t* idle_prepare_ = nullptr;
+  TaskQueue<v8::IdleTask> idle_tasks_;
+
   // Use a custom deleter because libuv needs to close the handle first.
   typedef std::unique_ptr<DelayedTask, std::function<void(DelayedTask*)>>
       DelayedTaskPointer;
   std::vector<DelayedTaskPointer> scheduled_delayed_tasks_;
 };
 
+// Counters for a single worker thread. They are only written by the worker
+// itself but may be read from any thread.
+struct WorkerStats {
+  std::atomic<uint64_t> tasks_run{0};
+  std::atomic<uint64_t> steals{0};
+  std::atomic<uint64_t> idle_time{0};  // nanoseconds
+};
+
+// Holds tasks posted with a delay on a min-heap ordered by due time, and hands
+// them to the worker pool from a dedicated thread once they are due. Tasks
+// that are still pending when the scheduler stops are destroyed without
+// running.
+class DelayedTaskScheduler {
+ public:
+  explicit DelayedTaskScheduler(v8::TaskRunner* runner);
+
+  void Start();
+  void PostDelayedTask(std::unique_ptr<v8::Task> task, double delay_in_seconds);
+  void Stop();
+
+ private:
+  struct ScheduledTask {
+    uint64_t due;  // uv_hrtime() based
+    uint64_t sequence;  // keeps tasks with the same due time in FIFO order
+    std::unique_ptr<v8::Task> task;
+  };
+
+  // std::push_heap builds a max-heap, so the comparison is inverted.
+  static bool Later(const ScheduledTask& a, const ScheduledTask& b) {
+    return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+  }
+
+  static void SchedulerMain(void* data);
+
+  v8::TaskRunner* runner_;
+  uv_thread_t thread_;
+  bool started_ = false;
+
+  Mutex lock_;
+  ConditionVariable changed_;
+  std::vector<ScheduledTask> heap_;
+  uint64_t next_sequence_ = 0;
+  bool stopped_ = false;
+};
+
 // This acts as the single worker threads task runner for all Isolates.
+//
+// Every worker thread owns a deque of tasks. Tasks posted from a worker go to
+// its own deque, and tasks posted from anywhere else are spread round-robin.
+// A worker takes tasks from the back of its own deque and, once that is
+// empty, steals from the front of the others, so there is no single lock that
+// every task has to go through.
 class WorkerThreadsTaskRunner : public v8::TaskRunner {
  public:
   explicit WorkerThreadsTaskRunner(int thread_pool_size);
@@ -108,10 +183,39 @@ class WorkerThreadsTaskRunner : public v8::TaskRunner {
   void Shutdown();
 
   int NumberOfWorkerThreads();
+  const WorkerStats& GetWorkerStats(int index);
 
  private:
-  TaskQueue<v8::Task> pending_worker_tasks_;
-  std::vector<std::unique_ptr<uv_thread_t>> threads_;
+  struct Worker {
+    WorkerThreadsTaskRunner* runner;
+    uv_thread_t thread;
+    Mutex lock;
+    std::deque<std::unique_ptr<v8::Task>> tasks;
+    WorkerStats stats;
+  };
+
+  static void WorkerMain(void* data);
+
+  std::unique_ptr<v8::Task> PopTask(Worker* worker);
+  void WaitForTasks(Worker* worker);
+  void NotifyOfCompletion();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<unsigned int> next_worker_{0};
+  DelayedTaskScheduler delayed_task_scheduler_;
+
+  // Posted tasks that no worker has picked up yet, and posted tasks that have
+  // not finished running yet.
+  std::atomic<int> queued_tasks_{0};
+  std::atomic<int> outstanding_tasks_{0};
+
+  // Only taken by workers that are out of work and by threads that need to
+  // wake them up or wait for them.
+  Mutex lock_;
+  ConditionVariable tasks_available_;
+  ConditionVariable tasks_drained_;
+  std::atomic<int> sleeping_workers_{0};
+  bool stopped_ = false;
 };
 
 class MultiIsolatePlatform;
@@ -143,13 +247,19 @@ class ZeroPlatform : public MultiIsolatePlatform {
   void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override;
   void CallDelayedOnForegroundThread(v8::Isolate* isolate, v8::Task* task,
                                      double delay_in_seconds) override;
-  bool IdleTasksEnabled(v8::Isolate*) override { return false; };
+  bool IdleTasksEnabled(v8::Isolate*) override { return true; };
+  void CallIdleOnForegroundThread(v8::Isolate* isolate, v8::IdleTask* task) override;
   double MonotonicallyIncreasingTime() override;
   double CurrentClockTimeMillis() override;
   v8::TracingController* GetTracingController() override;
 
   bool FlushForegroundTasks(v8::Isolate* isolate);
 
+  const WorkerStats& GetWorkerStats(int index);
+
+  // Number of worker threads to use when none is given with --v8-pool-size.
+  static int DefaultThreadPoolSize();
+
   void RegisterIsolate(v8::Isolate* isolate, uv_loop_t* loop) override;
   void UnregisterIsolate(v8::Isolate* isolate) override;
 
@@ -1,14 +1,28 @@
 #ifndef SRC_ZERO_SCRIPT_WRAP_H_
 #define SRC_ZERO_SCRIPT_WRAP_H_
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>  // memcpy
+#include <unistd.h>
+#include <uv.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "v8.h"
+#include "zero_code_cache.h"
 
 namespace zero {
 namespace ScriptWrap {
 
+// How the embedded code cache fared for the builtins compiled by Run.
+static struct {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t rejected = 0;
+} code_cache_stats;
+
 v8::MaybeLocal<v8::Value> Run(
     v8::Isolate* isolate, v8::Local<v8::String> filename, v8::Local<v8::String> code) {
   v8::Local<v8::Context> context = isolate->GetCurrentContext();
@@ -22,11 +36,28 @@ v8::MaybeLocal<v8::Value> Run(
                           v8::False(isolate),
                           v8::False(isolate),
                           v8::False(isolate));
-  v8::ScriptCompiler::Source source(code, origin);
+
+  v8::String::Utf8Value specifier(isolate, filename);
+  v8::ScriptCompiler::CachedData* cached_data = code_cache::Get(*specifier);
+  v8::ScriptCompiler::CompileOptions options = cached_data == nullptr ?
+    v8::ScriptCompiler::kNoCompileOptions :
+    v8::ScriptCompiler::kConsumeCodeCache;
+
+  // source takes ownership of cached_data
+  v8::ScriptCompiler::Source source(code, origin, cached_data);
 
   v8::Local<v8::UnboundScript> script;
   if (v8::ScriptCompiler::CompileUnboundScript(
-        isolate, &source, v8::ScriptCompiler::kNoCompileOptions).ToLocal(&script)) {
+        isolate, &source, options).ToLocal(&script)) {
+    if (cached_data == nullptr) {
+      code_cache_stats.misses += 1;
+    } else if (source.GetCachedData()->rejected) {
+      // V8 falls back to compiling from source, for example when zero is
+      // started with V8 flags that differ from the ones used at build time.
+      code_cache_stats.rejected += 1;
+    } else {
+      code_cache_stats.hits += 1;
+    }
     return script->BindToCurrentContext()->Run(context);
   }
 
@@ -42,13 +73,239 @@ static void Run(const v8::FunctionCallbackInfo<v8::Value>& args) {
   }
 }
 
+// Like Run, but for user scripts. Consumes the code cache passed as the third
+// argument, if any, and produces a new one after the script has run when
+// there was none or V8 rejected it.
+static void RunWithCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::ScriptOrigin origin(args[0].As<v8::String>());
+
+  v8::ScriptCompiler::CachedData* cached_data = nullptr;
+  if (args[2]->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> view = args[2].As<v8::ArrayBufferView>();
+    uint8_t* data = static_cast<uint8_t*>(view->Buffer()->GetContents().Data());
+    cached_data = new v8::ScriptCompiler::CachedData(
+        data + view->ByteOffset(), view->ByteLength());
+  }
+  v8::ScriptCompiler::CompileOptions options = cached_data == nullptr ?
+    v8::ScriptCompiler::kNoCompileOptions :
+    v8::ScriptCompiler::kConsumeCodeCache;
+
+  v8::ScriptCompiler::Source source(args[1].As<v8::String>(), origin, cached_data);
+
+  v8::Local<v8::UnboundScript> script;
+  if (!v8::ScriptCompiler::CompileUnboundScript(
+        isolate, &source, options).ToLocal(&script)) {
+    return;
+  }
+
+  v8::Local<v8::Value> result;
+  if (!script->BindToCurrentContext()->Run(context).ToLocal(&result)) {
+    return;
+  }
+
+  v8::Local<v8::Object> ret = v8::Object::New(isolate);
+  ZERO_SET_PROPERTY(context, ret, "result", result);
+
+  bool rejected = false;
+  if (cached_data != nullptr) {
+    rejected = source.GetCachedData()->rejected;
+    ZERO_SET_PROPERTY(context, ret, "cachedDataRejected", v8::Boolean::New(isolate, rejected));
+  }
+
+  if (cached_data == nullptr || rejected) {
+    std::unique_ptr<v8::ScriptCompiler::CachedData> new_data(
+        v8::ScriptCompiler::CreateCodeCache(script));
+    if (new_data) {
+      v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, new_data->length);
+      memcpy(buffer->GetContents().Data(), new_data->data, new_data->length);
+      ZERO_SET_PROPERTY(context, ret, "cachedData",
+                        v8::Uint8Array::New(buffer, 0, new_data->length));
+    }
+  }
+
+  args.GetReturnValue().Set(ret);
+}
+
+// Compiles and runs a script while it is still being read. The file is read
+// in chunks on a threadpool thread, where V8 parses each chunk as soon as it
+// arrives, so the main thread only finalizes the compile and runs the
+// script. V8 only streams classic scripts; modules are compiled on the main
+// thread by ModuleWrap.
+class StreamingJob {
+ public:
+  // runStreaming(filename, path) returns a promise of the completion value.
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::String::Utf8Value path(isolate, args[1]);
+
+    StreamingJob* job = new StreamingJob(isolate, args[0].As<v8::String>(), *path);
+    args.GetReturnValue().Set(job->resolver_.Get(isolate)->GetPromise());
+
+    job->task_.reset(v8::ScriptCompiler::StartStreamingScript(isolate, &job->source_));
+    int err = uv_queue_work(uv_default_loop(), &job->work_, DoWork, AfterWork);
+    if (err < 0) {
+      job->stream_->set_error(err);
+      AfterWork(&job->work_, 0);
+    }
+  }
+
+ private:
+  static const size_t kChunkSize = 64 * 1024;
+
+  // Reads the file for V8 as it asks for more, keeping a copy of everything
+  // read for the final compile.
+  class FileStream : public v8::ScriptCompiler::ExternalSourceStream {
+   public:
+    explicit FileStream(const std::string& path) : path_(path) {}
+
+    ~FileStream() override {
+      if (fd_ >= 0) {
+        close(fd_);
+      }
+    }
+
+    size_t GetMoreData(const uint8_t** src) override {
+      if (fd_ < 0 && err_ == 0) {
+        fd_ = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+          err_ = -errno;
+        }
+      }
+      if (err_ < 0) {
+        return 0;
+      }
+
+      // V8 takes ownership of the chunk.
+      uint8_t* chunk = new uint8_t[kChunkSize];
+      ssize_t n;
+      do {
+        n = read(fd_, chunk, kChunkSize);
+      } while (n < 0 && errno == EINTR);
+      if (n <= 0) {
+        err_ = n < 0 ? -errno : 0;
+        delete[] chunk;
+        return 0;
+      }
+      text_.append(reinterpret_cast<char*>(chunk), n);
+      *src = chunk;
+      return n;
+    }
+
+    void set_error(int err) { err_ = err; }
+    int error() const { return err_; }
+    const std::string& text() const { return text_; }
+
+   private:
+    std::string path_;
+    std::string text_;
+    int fd_ = -1;
+    int err_ = 0;
+  };
+
+  StreamingJob(v8::Isolate* isolate, v8::Local<v8::String> filename, const char* path)
+    : isolate_(isolate),
+      stream_(new FileStream(path)),
+      // source_ takes ownership of stream_
+      source_(stream_, v8::ScriptCompiler::StreamedSource::UTF8) {
+    resolver_.Reset(isolate, v8::Promise::Resolver::New(isolate));
+    filename_.Reset(isolate, filename);
+    work_.data = this;
+  }
+
+  static void DoWork(uv_work_t* work) {
+    static_cast<StreamingJob*>(work->data)->task_->Run();
+  }
+
+  static void AfterWork(uv_work_t* work, int status) {
+    StreamingJob* job = static_cast<StreamingJob*>(work->data);
+    v8::Isolate* isolate = job->isolate_;
+    InternalCallbackScope callback_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Promise::Resolver> resolver = job->resolver_.Get(isolate);
+
+    int err = status < 0 ? status : job->stream_->error();
+    if (err < 0) {
+      std::string e = "runStreaming: ";
+      e += uv_strerror(err);
+      v8::Local<v8::Object> v =
+          v8::Exception::Error(ZERO_STRING(isolate, e.c_str())).As<v8::Object>();
+      USE(v->Set(context, ZERO_STRING(isolate, "code"), v8::Number::New(isolate, err)));
+      resolver->Reject(context, v).ToChecked();
+      delete job;
+      return;
+    }
+
+    const std::string& text = job->stream_->text();
+    v8::Local<v8::String> full_source = v8::String::NewFromUtf8(
+        isolate, text.data(), v8::NewStringType::kNormal, text.size()).ToLocalChecked();
+    v8::ScriptOrigin origin(job->filename_.Get(isolate));
+
+    v8::TryCatch try_catch(isolate);
+    v8::Local<v8::Script> script;
+    v8::Local<v8::Value> result;
+    if (v8::ScriptCompiler::Compile(context, &job->source_, full_source, origin)
+            .ToLocal(&script) &&
+        script->Run(context).ToLocal(&result)) {
+      resolver->Resolve(context, result).ToChecked();
+    } else if (try_catch.CanContinue()) {
+      resolver->Reject(context, try_catch.Exception()).ToChecked();
+    }
+    delete job;
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Promise::Resolver> resolver_;
+  v8::Global<v8::String> filename_;
+  FileStream* stream_;
+  v8::ScriptCompiler::StreamedSource source_;
+  std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> task_;
+  uv_work_t work_;
+};
+
+static void GetCodeCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::Object> stats = v8::Object::New(isolate);
+  ZERO_SET_PROPERTY(context, stats, "hits", code_cache_stats.hits);
+  ZERO_SET_PROPERTY(context, stats, "misses", code_cache_stats.misses);
+  ZERO_SET_PROPERTY(context, stats, "rejected", code_cache_stats.rejected);
+
+  args.GetReturnValue().Set(stats);
+}
+
+// Computed on every call rather than stored at bootstrap: the tag includes a
+// hash of the V8 flags, and the flags a process runs with differ from the
+// ones the snapshot was built with.
+static void CachedDataVersionTag(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  args.GetReturnValue().Set(v8::Integer::NewFromUnsigned(
+      args.GetIsolate(), v8::ScriptCompiler::CachedDataVersionTag()));
+}
+
 void Init(v8::Local<v8::Context> context, v8::Local<v8::Object> exports) {
   ZERO_SET_PROPERTY(context, exports, "run", Run);
+  ZERO_SET_PROPERTY(context, exports, "runWithCache", RunWithCache);
+  ZERO_SET_PROPERTY(context, exports, "runStreaming", StreamingJob::Start);
+  ZERO_SET_PROPERTY(context, exports, "getCodeCacheStats", GetCodeCacheStats);
+  ZERO_SET_PROPERTY(context, exports, "cachedDataVersionTag", CachedDataVersionTag);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Run);
+  registry->Register(RunWithCache);
+  registry->Register(StreamingJob::Start);
+  registry->Register(GetCodeCacheStats);
+  registry->Register(CachedDataVersionTag);
 }
 
 }  // namespace ScriptWrap
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(script_wrap, zero::ScriptWrap::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(script_wrap, zero::ScriptWrap::RegisterExternalReferences);
 
 #endif  // SRC_ZERO_SCRIPT_WRAP_H_
@@ -0,0 +1,21 @@
+#ifndef SRC_ZERO_SNAPSHOT_H_
+#define SRC_ZERO_SNAPSHOT_H_
+
+#include "v8.h"
+
+namespace zero {
+namespace snapshot {
+
+// Indices of the values added to the snapshot with SnapshotCreator::AddData.
+enum SnapshotData {
+  kStartFunction,
+};
+
+// Returns the startup snapshot generated by `zero --build-snapshot`, or
+// nullptr when the binary was linked against the stub.
+v8::StartupData* GetStartupData();
+
+}  // namespace snapshot
+}  // namespace zero
+
+#endif  // SRC_ZERO_SNAPSHOT_H_
@@ -0,0 +1,14 @@
+#include "zero_snapshot.h"
+
+// Linked into out/zero_mksnapshot, which is used to generate the real
+// snapshot in out/zero_snapshot.cc.
+
+namespace zero {
+namespace snapshot {
+
+v8::StartupData* GetStartupData() {
+  return nullptr;
+}
+
+}  // namespace snapshot
+}  // namespace zero
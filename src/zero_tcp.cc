@@ -142,7 +142,14 @@ void Init(Local<Context> context, Local<Object> target) {
   target->Set(ZERO_STRING(isolate, "TCPWrap"), tpl->GetFunction());
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(TCPWrap::New);
+  registry->Register(TCPWrap::Connect);
+  registry->Register(TCPWrap::Listen);
+}
+
 }  // namespace tcp_wrap
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(tcp_wrap, zero::tcp_wrap::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(tcp_wrap, zero::tcp_wrap::RegisterExternalReferences);
@@ -1,8 +1,14 @@
+#include <cmath>
+#include <unordered_map>  // std::unordered_map
+#include <utility>  // std::swap
+#include <vector>
+
 #include "uv.h"
 #include "v8.h"
 #include "zero.h"
 #include "base_object-inl.h"
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -15,6 +21,16 @@ using v8::Value;
 namespace zero {
 namespace timer {
 
+static const double NS_PER_MS = 1000000;
+
+static double Now() {
+  return static_cast<double>(uv_hrtime()) / NS_PER_MS;
+}
+
+// Holds every pending timer of the isolate in a binary min-heap ordered by
+// expiry and then id, so timers with the same expiry fire in the order they
+// were created. A single uv_timer_t is armed for the earliest entry, and when
+// it fires all due ids are handed to JS in one call.
 class TimerWrap : public BaseObject {
  public:
   TimerWrap(Isolate* isolate, Local<Object> object, Local<Function> cb)
@@ -33,30 +49,165 @@ class TimerWrap : public BaseObject {
     new TimerWrap(args.GetIsolate(), args.This(), args[0].As<Function>());
   }
 
-  static void Update(const FunctionCallbackInfo<Value>& args) {
+  // schedule(id, timeout, repeat)
+  static void Schedule(const FunctionCallbackInfo<Value>& args) {
     TimerWrap* wrap;
     ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
 
-    int64_t timeout = args[0]->IntegerValue();
+    Local<Context> context = args.GetIsolate()->GetCurrentContext();
+    int64_t id = args[0]->IntegerValue(context).FromJust();
+    double timeout = args[1]->NumberValue(context).FromJust();
+    bool repeat = args[2]->IsTrue();
 
-    int err = uv_timer_start(&wrap->handle_, [](uv_timer_t* timer) {
-      auto wrap = static_cast<TimerWrap*>(timer->data);
-      Isolate* isolate = wrap->isolate();
-      InternalCallbackScope callback_scope(isolate);
-      v8::HandleScope handle_scope(isolate);
-      Local<Context> context = isolate->GetCurrentContext();
+    CHECK_EQ(wrap->positions_.count(id), 0);
+    wrap->Push({ Now() + timeout, id, repeat ? timeout : 0 });
+    wrap->Arm();
+  }
 
-      Local<Function> cb = wrap->callback_.Get(isolate);
+  // cancel(id) returns whether the timer was still pending.
+  static void Cancel(const FunctionCallbackInfo<Value>& args) {
+    TimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
 
-      USE(cb->Call(context, v8::Null(isolate), 0, {}));
-    }, timeout, 0);
+    Local<Context> context = args.GetIsolate()->GetCurrentContext();
+    int64_t id = args[0]->IntegerValue(context).FromJust();
 
-    args.GetReturnValue().Set(err);
+    auto it = wrap->positions_.find(id);
+    if (it == wrap->positions_.end()) {
+      args.GetReturnValue().Set(false);
+      return;
+    }
+    bool was_first = it->second == 0;
+    wrap->Remove(it->second);
+    if (was_first) {
+      wrap->Arm();
+    }
+    args.GetReturnValue().Set(true);
   }
 
  private:
+  struct Entry {
+    double expiry;
+    int64_t id;
+    double interval;  // 0 unless the timer repeats
+  };
+
+  static bool Before(const Entry& a, const Entry& b) {
+    return a.expiry < b.expiry || (a.expiry == b.expiry && a.id < b.id);
+  }
+
+  static void OnTimeout(uv_timer_t* timer) {
+    auto wrap = static_cast<TimerWrap*>(timer->data);
+    Isolate* isolate = wrap->isolate();
+    InternalCallbackScope callback_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    Local<Context> context = isolate->GetCurrentContext();
+
+    // Collect everything that is due before rescheduling intervals, so an
+    // interval fires at most once per turn even if it fell behind.
+    double now = Now();
+    std::vector<Entry> due;
+    while (!wrap->heap_.empty() && wrap->heap_[0].expiry <= now) {
+      due.push_back(wrap->heap_[0]);
+      wrap->Remove(0);
+    }
+
+    Local<Array> ids = Array::New(isolate, due.size());
+    for (size_t i = 0; i < due.size(); i += 1) {
+      const Entry& entry = due[i];
+      USE(ids->Set(context, i, v8::Number::New(isolate, entry.id)));
+      if (entry.interval > 0) {
+        wrap->Push({ entry.expiry + entry.interval, entry.id, entry.interval });
+      }
+    }
+    wrap->Arm();
+
+    if (due.empty()) {
+      return;
+    }
+
+    Local<Function> cb = wrap->callback_.Get(isolate);
+    Local<Value> argv[] = { ids };
+    USE(cb->Call(context, v8::Null(isolate), 1, argv));
+  }
+
+  // Starts the uv timer for the earliest entry, or stops it when there is
+  // nothing left so that the loop can exit.
+  void Arm() {
+    if (heap_.empty()) {
+      uv_timer_stop(&handle_);
+      return;
+    }
+    double delay = std::ceil(heap_[0].expiry - Now());
+    uint64_t timeout = delay > 0 ? static_cast<uint64_t>(delay) : 0;
+    uv_timer_start(&handle_, OnTimeout, timeout, 0);
+  }
+
+  void Push(const Entry& entry) {
+    heap_.push_back(entry);
+    positions_[entry.id] = heap_.size() - 1;
+    SiftUp(heap_.size() - 1);
+  }
+
+  void Remove(size_t index) {
+    positions_.erase(heap_[index].id);
+    size_t last = heap_.size() - 1;
+    if (index != last) {
+      Move(last, index);
+      heap_.pop_back();
+      SiftDown(SiftUp(index));
+    } else {
+      heap_.pop_back();
+    }
+  }
+
+  size_t SiftUp(size_t index) {
+    while (index > 0) {
+      size_t parent = (index - 1) / 2;
+      if (!Before(heap_[index], heap_[parent])) {
+        break;
+      }
+      Swap(index, parent);
+      index = parent;
+    }
+    return index;
+  }
+
+  void SiftDown(size_t index) {
+    size_t size = heap_.size();
+    for (;;) {
+      size_t smallest = index;
+      size_t left = (index * 2) + 1;
+      size_t right = left + 1;
+      if (left < size && Before(heap_[left], heap_[smallest])) {
+        smallest = left;
+      }
+      if (right < size && Before(heap_[right], heap_[smallest])) {
+        smallest = right;
+      }
+      if (smallest == index) {
+        return;
+      }
+      Swap(index, smallest);
+      index = smallest;
+    }
+  }
+
+  void Swap(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    positions_[heap_[a].id] = a;
+    positions_[heap_[b].id] = b;
+  }
+
+  void Move(size_t from, size_t to) {
+    heap_[to] = heap_[from];
+    positions_[heap_[to].id] = to;
+  }
+
   v8::Persistent<Function> callback_;
   uv_timer_t handle_;
+  std::vector<Entry> heap_;
+  std::unordered_map<int64_t, size_t> positions_;  // id -> index in heap_
 };
 
 static void Init(Local<Context> context, Local<Object> target) {
@@ -64,12 +215,20 @@ static void Init(Local<Context> context, Local<Object> target) {
 
   Local<FunctionTemplate> tpl = BaseObject::MakeJSTemplate(isolate, "TimerWrap", TimerWrap::New);
 
-  ZERO_SET_PROTO_PROP(context, tpl, "update", TimerWrap::Update);
+  ZERO_SET_PROTO_PROP(context, tpl, "schedule", TimerWrap::Schedule);
+  ZERO_SET_PROTO_PROP(context, tpl, "cancel", TimerWrap::Cancel);
 
   ZERO_SET_PROPERTY(context, target, "TimerWrap", tpl->GetFunction());
 }
 
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(TimerWrap::New);
+  registry->Register(TimerWrap::Schedule);
+  registry->Register(TimerWrap::Cancel);
+}
+
 }  // namespace timer
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(timer_wrap, zero::timer::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(timer_wrap, zero::timer::RegisterExternalReferences);
@@ -154,7 +154,15 @@ void Init(Local<Context> context, Local<Object> target) {
   target->Set(ZERO_STRING(isolate, "TTYWrap"), tpl->GetFunction());
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(TTYWrap::New);
+  registry->Register(TTYWrap::Write);
+  registry->Register(TTYWrap::End);
+  registry->Register(TTYWrap::SetBlocking);
+}
+
 }  // namespace tty
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(tty, zero::tty::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(tty, zero::tty::RegisterExternalReferences);
@@ -52,7 +52,14 @@ void Init(Local<Context> context, Local<Object> target) {
 #undef V
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+#define V(type) registry->Register(Is##type);
+  VALUE_METHOD_MAP(V)
+#undef V
+}
+
 }  // namespace types
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(types, zero::types::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(types, zero::types::RegisterExternalReferences);
@@ -0,0 +1,513 @@
+#include "zero_uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// IORING_FEAT_RW_CUR_POS (Linux 5.6) arrived with the open, close and statx
+// opcodes, and lets reads and writes use the file position like libuv does
+// for an offset of -1.
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(STATX_BASIC_STATS)
+#define ZERO_HAVE_IO_URING 1
+#endif
+
+#ifdef ZERO_HAVE_IO_URING
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#endif
+
+namespace zero {
+namespace uring {
+
+static bool enabled = false;
+
+void Enable() {
+  enabled = true;
+}
+
+#ifdef ZERO_HAVE_IO_URING
+
+namespace {
+
+const unsigned kEntries = 256;
+
+template <typename T>
+inline T LoadAcquire(const T* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+inline void StoreRelease(T* p, T v) {
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+// Everything a submitted request needs to stay alive until it completes.
+struct Op {
+  Op(uv_fs_t* req, uv_fs_type type, uv_fs_cb cb) : req(req), cb(cb) {
+    req->fs_type = type;
+  }
+
+  uv_fs_t* req;
+  uv_fs_cb cb;
+  std::string path;
+  std::vector<struct iovec> iov;
+  struct statx stx;
+};
+
+class Ring {
+ public:
+  ~Ring() {
+    if (event_fd_ != -1) {
+      close(event_fd_);
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != nullptr) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (fd_ != -1) {
+      close(fd_);
+    }
+  }
+
+  bool Init(uv_loop_t* loop) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    fd_ = syscall(__NR_io_uring_setup, kEntries, &p);
+    if (fd_ < 0) {
+      return false;
+    }
+    if ((p.features & IORING_FEAT_RW_CUR_POS) == 0 || !Probe()) {
+      return false;
+    }
+
+    sq_size_ = p.sq_off.array + (p.sq_entries * sizeof(unsigned));
+    cq_size_ = p.cq_off.cqes + (p.cq_entries * sizeof(struct io_uring_cqe));
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = sq_size_ > cq_size_ ? sq_size_ : cq_size_;
+    }
+
+    sq_ptr_ = Map(sq_size_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == nullptr) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_ : Map(cq_size_, IORING_OFF_CQ_RING);
+    if (cq_ptr_ == nullptr) {
+      return false;
+    }
+    sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) {
+      return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_entries_ = p.sq_entries;
+
+    char* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+    cq_entries_ = p.cq_entries;
+
+    event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0 ||
+        syscall(__NR_io_uring_register, fd_, IORING_REGISTER_EVENTFD, &event_fd_, 1) < 0) {
+      return false;
+    }
+
+    // Both handles stay unref'd while nothing is in flight so that an idle
+    // ring never keeps the loop alive.
+    poll_.data = this;
+    uv_poll_init(loop, &poll_, event_fd_);
+    uv_poll_start(&poll_, UV_READABLE, OnEvent);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&poll_));
+
+    prepare_.data = this;
+    uv_prepare_init(loop, &prepare_);
+    uv_prepare_start(&prepare_, OnPrepare);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&prepare_));
+
+    return true;
+  }
+
+  // Returns a zeroed SQE for |op|, or nullptr when the ring is full. Limiting
+  // requests in flight to the size of the completion queue means completions
+  // can never overflow it.
+  struct io_uring_sqe* GetSqe(Op* op) {
+    if (inflight_ >= cq_entries_) {
+      return nullptr;
+    }
+    unsigned tail = *sq_tail_;
+    if (tail - LoadAcquire(sq_head_) >= sq_entries_) {
+      Submit();
+      if (tail - LoadAcquire(sq_head_) >= sq_entries_) {
+        return nullptr;
+      }
+    }
+    unsigned index = tail & sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  // Publishes the SQE returned by the last GetSqe. It is handed to the
+  // kernel with everything else queued this turn, right before the loop
+  // polls for I/O.
+  void Commit() {
+    StoreRelease(sq_tail_, *sq_tail_ + 1);
+    pending_ += 1;
+    if (inflight_++ == 0) {
+      uv_ref(reinterpret_cast<uv_handle_t*>(&poll_));
+    }
+  }
+
+  void Submit() {
+    while (pending_ > 0) {
+      int r = syscall(__NR_io_uring_enter, fd_, pending_, 0, 0, nullptr, 0);
+      if (r < 0) {
+        // EAGAIN or EBUSY; try again on the next turn
+        return;
+      }
+      pending_ -= r;
+    }
+  }
+
+ private:
+  bool Probe() {
+    const size_t ops = 256;
+    size_t size = sizeof(struct io_uring_probe) + (ops * sizeof(struct io_uring_probe_op));
+    struct io_uring_probe* probe = static_cast<struct io_uring_probe*>(calloc(1, size));
+    bool supported =
+        syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, ops) >= 0;
+    const int needed[] = {
+      IORING_OP_OPENAT,
+      IORING_OP_CLOSE,
+      IORING_OP_READV,
+      IORING_OP_WRITEV,
+      IORING_OP_STATX,
+      IORING_OP_FSYNC,
+    };
+    for (int op : needed) {
+      if (!supported ||
+          op > probe->last_op ||
+          (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+        supported = false;
+      }
+    }
+    free(probe);
+    return supported;
+  }
+
+  void* Map(size_t size, off_t offset) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  static void OnPrepare(uv_prepare_t* handle) {
+    static_cast<Ring*>(handle->data)->Submit();
+  }
+
+  static void OnEvent(uv_poll_t* handle, int status, int events) {
+    Ring* ring = static_cast<Ring*>(handle->data);
+    uint64_t count;
+    while (read(ring->event_fd_, &count, sizeof(count)) > 0) {}
+    ring->Reap();
+  }
+
+  // Takes every available completion off the ring before running any
+  // callbacks, since those may submit new requests.
+  void Reap() {
+    std::vector<std::pair<Op*, int>> done;
+    unsigned head = *cq_head_;
+    unsigned tail = LoadAcquire(cq_tail_);
+    while (head != tail) {
+      struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+      done.emplace_back(reinterpret_cast<Op*>(cqe->user_data), cqe->res);
+      head += 1;
+    }
+    StoreRelease(cq_head_, head);
+
+    inflight_ -= done.size();
+    if (inflight_ == 0) {
+      uv_unref(reinterpret_cast<uv_handle_t*>(&poll_));
+    }
+
+    for (auto& entry : done) {
+      Complete(entry.first, entry.second);
+    }
+  }
+
+  static void Complete(Op* op, int result) {
+    uv_fs_t* req = op->req;
+    req->result = result;
+    if (result == 0 &&
+        (req->fs_type == UV_FS_STAT || req->fs_type == UV_FS_FSTAT)) {
+      const struct statx& s = op->stx;
+      uv_stat_t* buf = &req->statbuf;
+      memset(buf, 0, sizeof(*buf));
+      buf->st_dev = makedev(s.stx_dev_major, s.stx_dev_minor);
+      buf->st_mode = s.stx_mode;
+      buf->st_nlink = s.stx_nlink;
+      buf->st_uid = s.stx_uid;
+      buf->st_gid = s.stx_gid;
+      buf->st_rdev = makedev(s.stx_rdev_major, s.stx_rdev_minor);
+      buf->st_ino = s.stx_ino;
+      buf->st_size = s.stx_size;
+      buf->st_blksize = s.stx_blksize;
+      buf->st_blocks = s.stx_blocks;
+#define V(name, field)                                                        \
+      buf->st_##name.tv_sec = s.stx_##field.tv_sec;                           \
+      buf->st_##name.tv_nsec = s.stx_##field.tv_nsec;
+      V(atim, atime)
+      V(mtim, mtime)
+      V(ctim, ctime)
+      V(birthtim, btime)
+#undef V
+    }
+    uv_fs_cb cb = op->cb;
+    delete op;
+    cb(req);
+  }
+
+  int fd_ = -1;
+  int event_fd_ = -1;
+
+  void* sq_ptr_ = nullptr;
+  size_t sq_size_ = 0;
+  void* cq_ptr_ = nullptr;
+  size_t cq_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  struct io_uring_cqe* cqes_ = nullptr;
+  unsigned cq_mask_ = 0;
+  unsigned cq_entries_ = 0;
+
+  unsigned pending_ = 0;   // committed but not yet handed to the kernel
+  unsigned inflight_ = 0;  // committed but not yet reaped
+
+  uv_poll_t poll_;
+  uv_prepare_t prepare_;
+};
+
+Ring* ring = nullptr;
+bool ring_failed = false;
+
+Ring* GetRing() {
+  if (!enabled || ring_failed) {
+    return nullptr;
+  }
+  if (ring == nullptr) {
+    ring = new Ring();
+    if (!ring->Init(uv_default_loop())) {
+      delete ring;
+      ring = nullptr;
+      ring_failed = true;
+    }
+  }
+  return ring;
+}
+
+// Starts an op, or returns nullptr if the ring can't take it right now.
+struct io_uring_sqe* Start(uv_fs_t* req, uv_fs_type type, uv_fs_cb cb, Op** op) {
+  Ring* r = GetRing();
+  if (r == nullptr) {
+    return nullptr;
+  }
+  *op = new Op(req, type, cb);
+  struct io_uring_sqe* sqe = r->GetSqe(*op);
+  if (sqe == nullptr) {
+    delete *op;
+  }
+  return sqe;
+}
+
+void PrepareRw(struct io_uring_sqe* sqe, Op* op, int opcode, uv_file file,
+               const uv_buf_t bufs[], unsigned int nbufs, int64_t offset) {
+  op->iov.resize(nbufs);
+  for (unsigned int i = 0; i < nbufs; i += 1) {
+    op->iov[i].iov_base = bufs[i].base;
+    op->iov[i].iov_len = bufs[i].len;
+  }
+  sqe->opcode = opcode;
+  sqe->fd = file;
+  sqe->addr = reinterpret_cast<uintptr_t>(op->iov.data());
+  sqe->len = nbufs;
+  sqe->off = static_cast<uint64_t>(offset);
+}
+
+void PrepareStatx(struct io_uring_sqe* sqe, Op* op, int dirfd, int flags) {
+  sqe->opcode = IORING_OP_STATX;
+  sqe->fd = dirfd;
+  sqe->addr = reinterpret_cast<uintptr_t>(op->path.c_str());
+  sqe->len = STATX_BASIC_STATS | STATX_BTIME;
+  sqe->off = reinterpret_cast<uintptr_t>(&op->stx);
+  sqe->statx_flags = flags;
+}
+
+}  // anonymous namespace
+
+const char* Backend() {
+  return GetRing() != nullptr ? "io_uring" : "threadpool";
+}
+
+int fs_open(uv_fs_t* req, const char* path, int flags, int mode, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_OPEN, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  op->path = path;
+  sqe->opcode = IORING_OP_OPENAT;
+  sqe->fd = AT_FDCWD;
+  sqe->addr = reinterpret_cast<uintptr_t>(op->path.c_str());
+  sqe->len = mode;
+  sqe->open_flags = flags | O_CLOEXEC;
+  ring->Commit();
+  return 0;
+}
+
+int fs_close(uv_fs_t* req, uv_file file, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_CLOSE, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  sqe->opcode = IORING_OP_CLOSE;
+  sqe->fd = file;
+  ring->Commit();
+  return 0;
+}
+
+int fs_read(uv_fs_t* req, uv_file file, const uv_buf_t bufs[],
+            unsigned int nbufs, int64_t offset, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_READ, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  PrepareRw(sqe, op, IORING_OP_READV, file, bufs, nbufs, offset);
+  ring->Commit();
+  return 0;
+}
+
+int fs_write(uv_fs_t* req, uv_file file, const uv_buf_t bufs[],
+             unsigned int nbufs, int64_t offset, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_WRITE, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  PrepareRw(sqe, op, IORING_OP_WRITEV, file, bufs, nbufs, offset);
+  ring->Commit();
+  return 0;
+}
+
+int fs_stat(uv_fs_t* req, const char* path, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_STAT, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  op->path = path;
+  PrepareStatx(sqe, op, AT_FDCWD, AT_STATX_SYNC_AS_STAT);
+  ring->Commit();
+  return 0;
+}
+
+int fs_fstat(uv_fs_t* req, uv_file file, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_FSTAT, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  PrepareStatx(sqe, op, file, AT_STATX_SYNC_AS_STAT | AT_EMPTY_PATH);
+  ring->Commit();
+  return 0;
+}
+
+int fs_fsync(uv_fs_t* req, uv_file file, uv_fs_cb cb) {
+  Op* op;
+  struct io_uring_sqe* sqe = Start(req, UV_FS_FSYNC, cb, &op);
+  if (sqe == nullptr) {
+    return UV_ENOSYS;
+  }
+  sqe->opcode = IORING_OP_FSYNC;
+  sqe->fd = file;
+  ring->Commit();
+  return 0;
+}
+
+#else  // !ZERO_HAVE_IO_URING
+
+const char* Backend() {
+  return "threadpool";
+}
+
+int fs_open(uv_fs_t*, const char*, int, int, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_close(uv_fs_t*, uv_file, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_read(uv_fs_t*, uv_file, const uv_buf_t[], unsigned int, int64_t, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_write(uv_fs_t*, uv_file, const uv_buf_t[], unsigned int, int64_t, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_stat(uv_fs_t*, const char*, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_fstat(uv_fs_t*, uv_file, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+int fs_fsync(uv_fs_t*, uv_file, uv_fs_cb) {
+  return UV_ENOSYS;
+}
+
+#endif  // ZERO_HAVE_IO_URING
+
+}  // namespace uring
+}  // namespace zero
@@ -0,0 +1,38 @@
+#ifndef SRC_ZERO_URING_H_
+#define SRC_ZERO_URING_H_
+
+#include <uv.h>
+
+namespace zero {
+namespace uring {
+
+// Optional io_uring backend for the fs binding, selected with
+// --fs-backend=io_uring. The ring is set up on first use. Requests are
+// submitted from the loop thread in one io_uring_enter per loop turn, and
+// completions are reaped in one batch when the ring's eventfd is readable.
+//
+// Each fs_* function mirrors the uv_fs_* function of the same name. It
+// returns UV_ENOSYS when the request can't go through the ring (the backend
+// is disabled or unsupported, or the ring is full), in which case the caller
+// falls back to libuv. On completion |cb| runs with req->fs_type,
+// req->result and, for stats, req->statbuf filled in.
+
+void Enable();
+
+// "io_uring" once the ring is up, otherwise "threadpool".
+const char* Backend();
+
+int fs_open(uv_fs_t* req, const char* path, int flags, int mode, uv_fs_cb cb);
+int fs_close(uv_fs_t* req, uv_file file, uv_fs_cb cb);
+int fs_read(uv_fs_t* req, uv_file file, const uv_buf_t bufs[],
+            unsigned int nbufs, int64_t offset, uv_fs_cb cb);
+int fs_write(uv_fs_t* req, uv_file file, const uv_buf_t bufs[],
+             unsigned int nbufs, int64_t offset, uv_fs_cb cb);
+int fs_stat(uv_fs_t* req, const char* path, uv_fs_cb cb);
+int fs_fstat(uv_fs_t* req, uv_file file, uv_fs_cb cb);
+int fs_fsync(uv_fs_t* req, uv_file file, uv_fs_cb cb);
+
+}  // namespace uring
+}  // namespace zero
+
+#endif  // SRC_ZERO_URING_H_
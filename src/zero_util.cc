@@ -215,7 +215,23 @@ static void Init(Local<Context> context, Local<Object> target) {
 #undef V
 }
 
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(GetPromiseDetails);
+  registry->Register(GetProxyDetails);
+  registry->Register(RunMicrotasks);
+  registry->Register(EnqueueMicrotask);
+  registry->Register(SafeToString);
+  registry->Register(SetV8Flags);
+  registry->Register(CreateMessage);
+  registry->Register(PreviewEntries);
+  registry->Register(GetEnv);
+  registry->Register(SetEnv);
+  registry->Register(UnsetEnv);
+  registry->Register(WeakRef::New);
+}
+
 }  // namespace util
 }  // namespace zero
 
 ZERO_REGISTER_INTERNAL(util, zero::util::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(util, zero::util::RegisterExternalReferences);
@@ -0,0 +1,391 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <uv.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "v8.h"
+#include "zero.h"
+#include "base_object-inl.h"
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Persistent;
+using v8::Promise;
+using v8::String;
+using v8::Uint8Array;
+using v8::Value;
+
+namespace zero {
+namespace walk {
+
+// Stop reading directories while this many entries wait for JS to take them.
+static const size_t kHighWaterMark = 16 * 1024;
+// Largest batch handed to JS by one next().
+static const size_t kMaxBatch = 4096;
+
+struct Entry {
+  std::string path;  // relative to the root
+  int type;          // UV_DIRENT_*
+};
+
+static int TypeFromMode(mode_t mode) {
+  switch (mode & S_IFMT) {
+    case S_IFREG: return UV_DIRENT_FILE;
+    case S_IFDIR: return UV_DIRENT_DIR;
+    case S_IFLNK: return UV_DIRENT_LINK;
+    case S_IFIFO: return UV_DIRENT_FIFO;
+    case S_IFSOCK: return UV_DIRENT_SOCKET;
+    case S_IFCHR: return UV_DIRENT_CHAR;
+    case S_IFBLK: return UV_DIRENT_BLOCK;
+    default: return UV_DIRENT_UNKNOWN;
+  }
+}
+
+static int TypeFromDirent(unsigned char type) {
+  switch (type) {
+    case DT_REG: return UV_DIRENT_FILE;
+    case DT_DIR: return UV_DIRENT_DIR;
+    case DT_LNK: return UV_DIRENT_LINK;
+    case DT_FIFO: return UV_DIRENT_FIFO;
+    case DT_SOCK: return UV_DIRENT_SOCKET;
+    case DT_CHR: return UV_DIRENT_CHAR;
+    case DT_BLK: return UV_DIRENT_BLOCK;
+    default: return UV_DIRENT_UNKNOWN;
+  }
+}
+
+class WalkWrap;
+
+// One directory, read on the threadpool.
+struct DirJob {
+  uv_work_t work;
+  WalkWrap* walker;
+  std::string path;  // relative to the root, empty for the root itself
+  std::string full;  // path to open
+  double depth;      // depth of the entries in this directory
+  bool follow;
+  int err = 0;
+  dev_t dev = 0;
+  ino_t ino = 0;
+  std::vector<Entry> entries;
+
+  void Add(int dirfd, const char* name, unsigned char d_type) {
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+      return;
+    }
+    int type = TypeFromDirent(d_type);
+    // Some file systems don't fill in d_type, and followed links report the
+    // type of their target.
+    if (type == UV_DIRENT_UNKNOWN || (follow && type == UV_DIRENT_LINK)) {
+      struct stat s;
+      if (fstatat(dirfd, name, &s, follow ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+        type = TypeFromMode(s.st_mode);
+      }
+    }
+    entries.push_back({ path.empty() ? name : path + "/" + name, type });
+  }
+
+  void Read() {
+    int fd = open(full.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      err = -errno;
+      return;
+    }
+
+    struct stat s;
+    if (follow && fstat(fd, &s) == 0) {
+      dev = s.st_dev;
+      ino = s.st_ino;
+    }
+
+#ifdef __linux__
+    // getdents64 fills a much larger buffer per syscall than readdir does.
+    alignas(struct dirent64) char buf[64 * 1024];
+    for (;;) {
+      long n = syscall(SYS_getdents64, fd, buf, sizeof(buf));  // NOLINT(runtime/int)
+      if (n < 0) {
+        err = -errno;
+        break;
+      }
+      if (n == 0) {
+        break;
+      }
+      for (long offset = 0; offset < n;) {  // NOLINT(runtime/int)
+        auto ent = reinterpret_cast<struct dirent64*>(buf + offset);
+        Add(fd, ent->d_name, ent->d_type);
+        offset += ent->d_reclen;
+      }
+    }
+    close(fd);
+#else
+    DIR* dir = fdopendir(fd);
+    if (dir == nullptr) {
+      err = -errno;
+      close(fd);
+      return;
+    }
+    errno = 0;
+    while (struct dirent* ent = readdir(dir)) {
+      Add(fd, ent->d_name, ent->d_type);
+    }
+    if (errno != 0) {
+      err = -errno;
+    }
+    closedir(dir);
+#endif
+  }
+};
+
+// Walks a directory tree breadth first, reading up to |concurrency|
+// directories at once on the threadpool. Entries are buffered until JS takes
+// them with next(), and reading pauses while too many are waiting, so
+// memory stays bounded however large the tree is.
+//
+// The wrapper is only weak while no directory reads are in flight, since
+// they point back at it.
+class WalkWrap : public BaseObject {
+ public:
+  // new Walker(root, maxDepth, followSymlinks, concurrency)
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Isolate* isolate = args.GetIsolate();
+    Local<Context> context = isolate->GetCurrentContext();
+    String::Utf8Value root(isolate, args[0]);
+    double max_depth = args[1]->NumberValue(context).FromJust();
+    bool follow = args[2]->IsTrue();
+    int32_t concurrency = args[3]->Int32Value(context).FromJust();
+
+    new WalkWrap(isolate, args.This(), *root, max_depth, follow,
+                 concurrency > 0 ? concurrency : 1);
+    args.GetReturnValue().Set(args.This());
+  }
+
+  // Resolves with [paths, types] for the next batch of entries, where
+  // types is a Uint8Array of UV_DIRENT_* values, or with null once the walk
+  // is done.
+  static void Next(const FunctionCallbackInfo<Value>& args) {
+    WalkWrap* that;
+    ASSIGN_OR_RETURN_UNWRAP(&that, args.This());
+    Isolate* isolate = args.GetIsolate();
+
+    if (!that->pending_.IsEmpty()) {
+      ZERO_THROW_EXCEPTION(isolate, "next() is already pending");
+      return;
+    }
+
+    Local<Promise::Resolver> resolver = Promise::Resolver::New(isolate);
+    that->pending_.Reset(isolate, resolver);
+    args.GetReturnValue().Set(resolver->GetPromise());
+
+    that->Settle();
+    that->Pump();
+  }
+
+  // Stops the walk. Reads already in flight finish but are discarded.
+  static void Close(const FunctionCallbackInfo<Value>& args) {
+    WalkWrap* that;
+    ASSIGN_OR_RETURN_UNWRAP(&that, args.This());
+
+    that->closed_ = true;
+    that->queue_.clear();
+    that->buffered_.clear();
+    that->Settle();
+  }
+
+ private:
+  WalkWrap(Isolate* isolate,
+           Local<Object> object,
+           const char* root,
+           double max_depth,
+           bool follow,
+           size_t concurrency)
+    : BaseObject(isolate, object),
+      root_(root),
+      max_depth_(max_depth),
+      follow_(follow),
+      concurrency_(concurrency) {
+    queue_.emplace_back("", 1);
+    MakeWeak();
+  }
+
+  ~WalkWrap() {
+    pending_.Reset();
+  }
+
+  bool done() const {
+    return closed_ || err_ < 0 || (active_ == 0 && queue_.empty());
+  }
+
+  void Pump() {
+    uv_loop_t* loop = uv_default_loop();
+    while (!closed_ &&
+           err_ == 0 &&
+           active_ < concurrency_ &&
+           !queue_.empty() &&
+           buffered_.size() < kHighWaterMark) {
+      DirJob* job = new DirJob;
+      job->work.data = job;
+      job->walker = this;
+      job->path = std::move(queue_.front().first);
+      job->full = job->path.empty() ? root_ : root_ + "/" + job->path;
+      job->depth = queue_.front().second;
+      job->follow = follow_;
+      queue_.pop_front();
+
+      int err = uv_queue_work(loop, &job->work, DoRead, AfterRead);
+      if (err < 0) {
+        err_ = err;
+        delete job;
+        break;
+      }
+      if (active_ == 0) {
+        ClearWeak();
+      }
+      active_ += 1;
+    }
+  }
+
+  static void DoRead(uv_work_t* work) {
+    static_cast<DirJob*>(work->data)->Read();
+  }
+
+  static void AfterRead(uv_work_t* work, int status) {
+    DirJob* job = static_cast<DirJob*>(work->data);
+    WalkWrap* self = job->walker;
+    Isolate* isolate = self->isolate();
+    InternalCallbackScope callback_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+
+    self->active_ -= 1;
+    self->Collect(job, status < 0 ? status : job->err);
+    delete job;
+
+    self->Settle();
+    self->Pump();
+    if (self->active_ == 0) {
+      self->MakeWeak();
+    }
+  }
+
+  void Collect(DirJob* job, int err) {
+    if (closed_ || err_ < 0) {
+      return;
+    }
+    if (err < 0) {
+      // Entries removed while the walk is running are skipped, but the root
+      // has to exist.
+      if (job->path.empty() || (err != UV_ENOENT && err != UV_ENOTDIR)) {
+        err_ = err;
+        err_path_ = job->full;
+      }
+      return;
+    }
+    // Following links can lead back into a directory already walked.
+    if (follow_ && !visited_.emplace(job->dev, job->ino).second) {
+      return;
+    }
+    for (Entry& entry : job->entries) {
+      if (entry.type == UV_DIRENT_DIR && job->depth < max_depth_) {
+        queue_.emplace_back(entry.path, job->depth + 1);
+      }
+      buffered_.push_back(std::move(entry));
+    }
+  }
+
+  // Settles a pending next() if there is anything to report.
+  void Settle() {
+    if (pending_.IsEmpty()) {
+      return;
+    }
+    Isolate* isolate = this->isolate();
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Promise::Resolver> resolver = pending_.Get(isolate);
+
+    if (!buffered_.empty()) {
+      size_t count = std::min(buffered_.size(), kMaxBatch);
+      Local<Array> paths = Array::New(isolate, count);
+      Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, count);
+      uint8_t* types = static_cast<uint8_t*>(buffer->GetContents().Data());
+      for (size_t i = 0; i < count; i += 1) {
+        const Entry& entry = buffered_.front();
+        USE(paths->Set(context, i, ZERO_STRING(isolate, entry.path.c_str())));
+        types[i] = entry.type;
+        buffered_.pop_front();
+      }
+      Local<Array> batch = Array::New(isolate, 2);
+      USE(batch->Set(context, 0, paths));
+      USE(batch->Set(context, 1, Uint8Array::New(buffer, 0, count)));
+      pending_.Reset();
+      resolver->Resolve(context, batch).ToChecked();
+    } else if (err_ < 0 && !closed_) {
+      std::string e = "walk: ";
+      e += uv_strerror(err_);
+      e += ", ";
+      e += err_path_;
+      Local<Object> v = v8::Exception::Error(ZERO_STRING(isolate, e.c_str())).As<Object>();
+      USE(v->Set(context, ZERO_STRING(isolate, "code"), Number::New(isolate, err_)));
+      // Report the error once, then behave as if closed.
+      closed_ = true;
+      queue_.clear();
+      pending_.Reset();
+      resolver->Reject(context, v).ToChecked();
+    } else if (done()) {
+      pending_.Reset();
+      resolver->Resolve(context, v8::Null(isolate)).ToChecked();
+    }
+  }
+
+  std::string root_;
+  double max_depth_;
+  bool follow_;
+  size_t concurrency_;
+
+  std::deque<std::pair<std::string, double>> queue_;  // directories to read
+  std::deque<Entry> buffered_;
+  std::set<std::pair<dev_t, ino_t>> visited_;
+  Persistent<Promise::Resolver> pending_;
+  size_t active_ = 0;
+  int err_ = 0;
+  std::string err_path_;
+  bool closed_ = false;
+};
+
+static void Init(Local<Context> context, Local<Object> target) {
+  Isolate* isolate = context->GetIsolate();
+  Local<FunctionTemplate> tpl =
+      BaseObject::MakeJSTemplate(isolate, "Walker", WalkWrap::New);
+
+  ZERO_SET_PROTO_PROP(context, tpl, "next", WalkWrap::Next);
+  ZERO_SET_PROTO_PROP(context, tpl, "close", WalkWrap::Close);
+
+  ZERO_SET_PROPERTY(context, target, "Walker",
+                    tpl->GetFunction(context).ToLocalChecked());
+}
+
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(WalkWrap::New);
+  registry->Register(WalkWrap::Next);
+  registry->Register(WalkWrap::Close);
+}
+
+}  // namespace walk
+}  // namespace zero
+
+ZERO_REGISTER_INTERNAL(walk, zero::walk::Init);
+ZERO_REGISTER_EXTERNAL_REFERENCES(walk, zero::walk::RegisterExternalReferences);
@@ -0,0 +1,14 @@
+import { pass, assertEqual } from '../common';
+
+const { getCodeCacheStats } = binding('script_wrap'); // eslint-disable-line no-undef
+
+const before = getCodeCacheStats();
+
+// loads lib/ffi.js on first access, after start() has changed V8's flags
+assertEqual(typeof DynamicLibrary, 'function'); // eslint-disable-line no-undef
+
+const after = getCodeCacheStats();
+assertEqual(after.rejected, 0);
+assertEqual(after.hits > before.hits, true);
+
+pass();
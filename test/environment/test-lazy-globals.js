@@ -0,0 +1,13 @@
+import { assert, assertEqual } from '../common';
+
+const descriptor = () => Object.getOwnPropertyDescriptor(global, 'WebSocket');
+
+assert(typeof descriptor().get === 'function');
+
+const { WebSocket } = global;
+assertEqual(typeof WebSocket, 'function');
+
+assertEqual(descriptor().get, undefined);
+assertEqual(descriptor().value, WebSocket);
+assertEqual(descriptor().writable, true);
+assertEqual(descriptor().enumerable, false);
@@ -0,0 +1,52 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const source = new URL('fs_copy_range_source.txt', fixtures);
+const target = new URL('fs_copy_range_target.txt', fixtures);
+
+const read = (url) => fileSystem.readFile(url, { encoding: 'utf8' });
+
+(async () => {
+  await fileSystem.writeFile(source, 'hello world');
+
+  // the whole file, which may be cloned
+  assertEqual(await fileSystem.copyRange(source, target), 11);
+  assertEqual(await read(target), 'hello world');
+
+  assertEqual(await fileSystem.copyRange(source, target, {
+    position: 6,
+    length: 5,
+    targetPosition: 0,
+  }), 5);
+  assertEqual(await read(target), 'world world');
+
+  // stops at the end of the input
+  assertEqual(await fileSystem.copyRange(source, target, { position: 8, length: 100 }), 3);
+  assertEqual(await read(target), 'rldld world');
+
+  const from = await fileSystem.open(source, { write: false });
+  const to = await fileSystem.open(target, { read: false });
+  assertEqual(await from.sendTo(to, { position: 0, length: 5 }), 5);
+  assertEqual(await from.sendTo(to, { position: 5 }), 6);
+  assertEqual(await read(target), 'hello world');
+
+  let error;
+  try {
+    await from.sendTo('stdout');
+  } catch (e) {
+    error = e;
+  }
+  assertEqual(error instanceof TypeError, true);
+
+  error = undefined;
+  try {
+    await from.copyTo(to, { position: -1 });
+  } catch (e) {
+    error = e;
+  }
+  assertEqual(error instanceof RangeError, true);
+
+  await from.close();
+  await to.close();
+  await fileSystem.removeFile(source);
+  await fileSystem.removeFile(target);
+})().then(pass).catch(fail);
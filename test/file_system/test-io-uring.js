@@ -0,0 +1,37 @@
+// env ZERO_FS_BACKEND=io_uring
+
+import { pass, fail, assert, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const { getBackend } = binding('fs'); // eslint-disable-line no-undef
+
+const path = new URL('fs_io_uring_output.txt', fixtures);
+
+// The same operations have to behave identically whichever backend runs them.
+(async () => {
+  const handle = await fileSystem.open(path, { create: true });
+  assert(['io_uring', 'threadpool'].includes(getBackend()));
+
+  await handle.writev(['hello', ' ', 'ring']);
+  await handle.sync();
+
+  const stats = await handle.stat();
+  assertEqual(stats.size, 10);
+  assertEqual(stats.isDir, false);
+  assertEqual((await fileSystem.stat(path)).size, 10);
+
+  assertDeepEqual(await handle.read({ size: 4, position: 6 }),
+    new Uint8Array([114, 105, 110, 103]));
+  const into = new Uint8Array(5);
+  assertEqual(await handle.read({ into, position: 0 }), 5);
+  assertEqual(String.fromCharCode(...into), 'hello');
+
+  await handle.close();
+  await fileSystem.removeFile(path);
+
+  try {
+    await fileSystem.stat(path);
+    fail('stat of a removed file resolved');
+  } catch (e) {
+    assert(e.message.startsWith('stat: '));
+  }
+})().then(pass).catch(fail);
@@ -0,0 +1,26 @@
+import { pass, fail, assert, assertEqual, fixtures } from '../common';
+
+const url = new URL('hello.txt', fixtures);
+
+(async () => {
+  const mapping = await fileSystem.map(url, { offset: 1, length: 3 });
+  const bytes = new Uint8Array(mapping.buffer);
+  assertEqual(String.fromCharCode(...bytes), 'ell');
+
+  mapping.advise('random');
+
+  // read-only mappings are copy-on-write
+  bytes[0] = 0;
+  assertEqual(await fileSystem.readFile(url, { encoding: 'utf8' }), 'hello\n');
+
+  assertEqual(mapping.unmap(), true);
+  assertEqual(mapping.buffer.byteLength, 0);
+  assertEqual(mapping.unmap(), false);
+
+  try {
+    await fileSystem.map(url, { offset: 4, length: 10 });
+    assert(false);
+  } catch (e) {
+    assert(e instanceof RangeError);
+  }
+})().then(pass).catch(fail);
@@ -0,0 +1,30 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const dir = new URL('fs_open_directory/', fixtures);
+const count = 10;
+
+(async () => {
+  await fileSystem.createDirectory(dir, { unixMode: 0o777 });
+  await Promise.all(Array.from({ length: count }, (_, i) =>
+    fileSystem.writeFile(new URL(`${i}.txt`, dir), '')));
+  await fileSystem.createDirectory(new URL('sub/', dir), { unixMode: 0o777 });
+
+  const sizes = [];
+  const entries = [];
+  for await (const batch of fileSystem.openDirectory(dir, { batchSize: 3 })) {
+    sizes.push(batch.length);
+    entries.push(...batch);
+  }
+  assertEqual(sizes.every((size) => size <= 3), true);
+  assertEqual(entries.length, count + 1);
+  assertDeepEqual(entries.find(({ name }) => name === 'sub'), { name: 'sub', type: 'directory' });
+  assertDeepEqual(entries.find(({ name }) => name === '0.txt'), { name: '0.txt', type: 'file' });
+
+  // stopping early closes the directory
+  for await (const batch of fileSystem.openDirectory(dir, { batchSize: 1 })) {
+    assertEqual(batch.length, 1);
+    break;
+  }
+
+  await fileSystem.removeDirectory(dir, { recursive: true });
+})().then(pass).catch(fail);
@@ -0,0 +1,27 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const { getBufferPoolStats } = binding('fs'); // eslint-disable-line no-undef
+
+const url = new URL('hello.txt', fixtures);
+
+(async () => {
+  const handle = await fileSystem.open(url, { write: false });
+
+  const into = new Uint8Array(8).fill(0);
+  const view = into.subarray(1, 4);
+  assertEqual(await handle.read({ into: view, position: 0 }), 3);
+  assertDeepEqual(into, new Uint8Array([0, 104, 101, 108, 0, 0, 0, 0]));
+
+  assertEqual(await handle.read({ into, position: 4 }), 2);
+  assertDeepEqual(into.subarray(0, 2), new Uint8Array([111, 10]));
+
+  const before = getBufferPoolStats();
+  const buffer = await handle.read({ size: 3, position: 1 });
+  assertDeepEqual(buffer, new Uint8Array([101, 108, 108]));
+  // the result never exposes the rest of the pooled allocation
+  assertEqual(buffer.buffer.byteLength, 3);
+  const after = getBufferPoolStats();
+  assertEqual(after.hits + after.misses, before.hits + before.misses + 1);
+
+  await handle.close();
+})().then(pass).catch(fail);
@@ -0,0 +1,28 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const path = new URL('fs_writev_output.txt', fixtures);
+
+(async () => {
+  await fileSystem.removeFile(path, { ignoreAbsent: true });
+  const backing = new Uint8Array([0, 1, 2, 3, 4, 5, 6, 7]);
+  const handle = await fileSystem.open(path, { create: true });
+
+  // only the bytes of each view are written, not the rest of its buffer
+  const written = await handle.writev(['<', backing.subarray(2, 5), '>']);
+  assertEqual(written, 5);
+
+  const head = new Uint8Array(2);
+  const tail = new Uint8Array(8).fill(9);
+  assertEqual(await handle.readv([head, tail.subarray(0, 3)], { position: 0 }), 5);
+  assertDeepEqual(head, new Uint8Array([60, 2]));
+  assertDeepEqual(tail, new Uint8Array([3, 4, 62, 9, 9, 9, 9, 9]));
+
+  assertEqual(await handle.writev([]), 0);
+  assertEqual(await handle.readv([], { position: 0 }), 0);
+
+  await handle.write(backing.subarray(6), { position: 1 });
+  assertDeepEqual(await fileSystem.readFile(path), new Uint8Array([60, 6, 7, 4, 62]));
+
+  await handle.close();
+  await fileSystem.removeFile(path);
+})().then(pass).catch(fail);
@@ -0,0 +1,26 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const hello = new URL('hello.txt', fixtures);
+const missing = new URL('does-not-exist.txt', fixtures);
+
+(async () => {
+  const [file, dir, none] = await fileSystem.statMany([hello, fixtures, missing]);
+
+  assertEqual(file.isDir, false);
+  assertEqual(file.size, 6);
+  assertEqual(typeof file.lastModificationDate, 'bigint');
+  assertEqual(dir.isDir, true);
+  assertEqual(none, null);
+
+  // matches the single stat, which shares the layout
+  const single = await fileSystem.stat(hello);
+  assertEqual(single.lastModificationDate, file.lastModificationDate);
+  assertEqual(single.unixMode, file.unixMode);
+
+  // enough paths to be split across several threadpool jobs
+  const many = await fileSystem.statMany(Array.from({ length: 100 }, () => hello));
+  assertEqual(many.length, 100);
+  assertEqual(many.every((s) => s.size === 6), true);
+
+  assertEqual((await fileSystem.statMany([])).length, 0);
+})().then(pass).catch(fail);
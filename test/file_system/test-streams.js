@@ -0,0 +1,40 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const path = new URL('fs_stream_output.txt', fixtures);
+
+const collect = async (stream) => {
+  const reader = stream.getReader();
+  const chunks = [];
+  for (;;) {
+    const { value, done } = await reader.read(); // eslint-disable-line no-await-in-loop
+    if (done) {
+      return chunks;
+    }
+    chunks.push(value);
+  }
+};
+
+(async () => {
+  await fileSystem.removeFile(path, { ignoreAbsent: true });
+  const handle = await fileSystem.open(path, { create: true });
+
+  const writer = handle.createWritable({ highWaterMark: 4 }).getWriter();
+  await writer.write('abcd');
+  await writer.write(new Uint8Array([101, 102, 103]));
+  await writer.close();
+
+  // chunks are bounded by chunkSize and the stream ends at EOF
+  const chunks = await collect(handle.createReadable({ chunkSize: 3, position: 0 }));
+  assertDeepEqual(chunks.map((c) => c.length), [3, 3, 1]);
+  assertEqual(String.fromCharCode(...chunks[2]), 'g');
+
+  // BYOB reads land in the caller's buffer
+  const reader = handle.createReadable({ position: 2, highWaterMark: 0 })
+    .getReader({ mode: 'byob' });
+  const { value } = await reader.read(new Uint8Array(2));
+  assertDeepEqual(value, new Uint8Array([99, 100]));
+  reader.releaseLock();
+
+  await handle.close();
+  await fileSystem.removeFile(path);
+})().then(pass).catch(fail);
@@ -0,0 +1,70 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const root = new URL('fs_walk_tree/', fixtures);
+const copied = new URL('fs_walk_copy/', fixtures);
+
+const collect = async (url, options) => {
+  const entries = [];
+  for await (const batch of fileSystem.walk(url, options)) {
+    entries.push(...batch);
+  }
+  return entries;
+};
+
+(async () => {
+  await fileSystem.createDirectory(root, { unixMode: 0o777 });
+  await fileSystem.createDirectory(new URL('a/', root), { unixMode: 0o777 });
+  await fileSystem.createDirectory(new URL('a/b/', root), { unixMode: 0o777 });
+  await fileSystem.writeFile(new URL('top.txt', root), 'top');
+  await fileSystem.writeFile(new URL('a/b/deep.txt', root), 'deep');
+
+  const entries = await collect(root);
+  assertDeepEqual(entries.map(({ path, type }) => `${path}:${type}`).sort(), [
+    'a/b/deep.txt:file',
+    'a/b:directory',
+    'a:directory',
+    'top.txt:file',
+  ]);
+  // a directory always comes before its contents
+  const paths = entries.map(({ path }) => path);
+  assertEqual(paths.indexOf('a') < paths.indexOf('a/b'), true);
+  assertEqual(paths.indexOf('a/b') < paths.indexOf('a/b/deep.txt'), true);
+
+  const shallow = await collect(root, { maxDepth: 1 });
+  assertDeepEqual(shallow.map(({ path }) => path).sort(), ['a', 'top.txt']);
+
+  // stopping early closes the walk
+  for await (const batch of fileSystem.walk(root)) {
+    assertEqual(batch.length > 0, true);
+    break;
+  }
+
+  // links are recreated rather than followed, even when they point at a
+  // directory or at nothing
+  await fileSystem.createSymbolicLink(new URL('a/', root), new URL('dir-link', root));
+  await fileSystem.createSymbolicLink(new URL('missing', root), new URL('dangling', root));
+
+  await fileSystem.copy(root, copied, { recursive: true });
+  assertEqual(await fileSystem.readFile(new URL('a/b/deep.txt', copied), { encoding: 'utf8' }),
+    'deep');
+  const copiedEntries = await collect(copied, { maxDepth: 1 });
+  assertDeepEqual(copiedEntries.map(({ path, type }) => `${path}:${type}`).sort(), [
+    'a:directory',
+    'dangling:link',
+    'dir-link:link',
+    'top.txt:file',
+  ]);
+
+  await fileSystem.removeDirectory(root, { recursive: true });
+  await fileSystem.removeDirectory(copied, { recursive: true });
+  assertEqual(await fileSystem.exists(root), false);
+  assertEqual(await fileSystem.exists(copied), false);
+
+  let error;
+  try {
+    await collect(root);
+  } catch (e) {
+    error = e;
+  }
+  assertEqual(typeof error.code, 'number');
+})().then(pass).catch(fail);
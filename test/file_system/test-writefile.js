@@ -0,0 +1,21 @@
+import { pass, fail, assertEqual, assertDeepEqual, fixtures } from '../common';
+
+const path = new URL('fs_writefile_output.txt', fixtures);
+
+(async () => {
+  await fileSystem.writeFile(path, 'abcdef');
+  await fileSystem.writeFile(path, new Uint8Array([120, 121, 122]).subarray(1));
+  assertEqual(await fileSystem.readFile(path, { encoding: 'utf8' }), 'yz');
+
+  await fileSystem.writeFile(path, '!', { append: true, sync: true });
+  assertDeepEqual(await fileSystem.readFile(path), new Uint8Array([121, 122, 33]));
+
+  await fileSystem.removeFile(path);
+
+  try {
+    await fileSystem.readFile(path);
+    fail('readFile of a missing file resolved');
+  } catch (e) {
+    assertEqual(e.message.startsWith('readFile: '), true);
+  }
+})().then(pass).catch(fail);
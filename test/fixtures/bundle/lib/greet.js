@@ -0,0 +1,2 @@
+// not Latin-1, so stored as UTF-16
+export const greet = (name) => `héllo ${name} ☃`;
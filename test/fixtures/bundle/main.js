@@ -0,0 +1,6 @@
+import { greet } from './lib/greet';
+import { value } from 'data:text/javascript,export const value = 1;';
+
+export const url = import.meta.url;
+export const message = `${greet('bundle')} ${value}`;
+export const load = (specifier) => import(specifier);
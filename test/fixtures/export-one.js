@@ -0,0 +1 @@
+export const one = 1;
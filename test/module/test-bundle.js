@@ -0,0 +1,26 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const bundle = new URL('bundle.zb', fixtures);
+
+(async () => {
+  await environment.createBundle(new URL('bundle/main.js', fixtures), bundle);
+
+  const header = await fileSystem.readFile(bundle, { encoding: 'utf8' });
+  assertEqual(header.slice(0, 8), 'ZEROBNDL');
+
+  const ns = await environment.importBundle(bundle);
+  assertEqual(ns.url, `${bundle}/main.js`);
+  assertEqual(ns.message, 'héllo bundle ☃ 1');
+
+  // imports are resolved from the table made with the bundle
+  assertEqual((await ns.load('./lib/greet')).greet('x'), 'héllo x ☃');
+  let error;
+  try {
+    await ns.load('./lib/greet.js');
+  } catch (e) {
+    error = e;
+  }
+  assertEqual(error.message, 'unable to resolve ./lib/greet.js in bundle');
+
+  await fileSystem.removeFile(bundle);
+})().then(pass).catch(fail);
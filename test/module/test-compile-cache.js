@@ -0,0 +1,51 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+// env ZERO_COMPILE_CACHE=/tmp/zero-test-compile-cache
+
+const { ModuleWrap } = binding('module_wrap'); // eslint-disable-line no-undef
+
+const root = '/tmp/zero-test-compile-cache';
+const { directory } = environment.compileCacheStats;
+const url = `${fixtures}export-one.js`;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// Whether a cache on disk is accepted by V8 for `source`, as it would be
+// when a later process loads the module. Only the module's own cache
+// matches its source.
+const hasCache = async (source) => {
+  let entries;
+  try {
+    entries = await fileSystem.readDirectory(directory);
+  } catch (e) {
+    return false;
+  }
+  const accepted = await Promise.all(entries
+    .filter(({ name }) => name.endsWith('.cache'))
+    .map(async ({ name }) => {
+      const data = await fileSystem.readFile(`${directory}/${name}`);
+      return !new ModuleWrap(source, url, data).cachedDataRejected;
+    }));
+  return accepted.includes(true);
+};
+
+const cleanup = () => fileSystem.removeDirectory(root, { recursive: true });
+
+(async () => {
+  const { misses } = environment.compileCacheStats;
+  const { one } = await import(url);
+  assertEqual(one, 1);
+  assertEqual(environment.compileCacheStats.misses, misses + 1);
+
+  // written in the background once the module has been evaluated
+  const source = await fileSystem.readFile(url, { encoding: 'utf8' });
+  let found = false;
+  for (let i = 0; !found && i < 100; i += 1) {
+    await sleep(10); // eslint-disable-line no-await-in-loop
+    found = await hasCache(source); // eslint-disable-line no-await-in-loop
+  }
+  assertEqual(found, true);
+})()
+  .then(cleanup)
+  .then(pass)
+  .catch((e) => cleanup().catch(() => {}).then(() => fail(e)));
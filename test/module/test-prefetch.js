@@ -0,0 +1,33 @@
+import { pass, fail, assertEqual, assertDeepEqual } from '../common';
+
+const { scanImports } = binding('module_wrap'); // eslint-disable-line no-undef
+
+const encoder = new TextEncoder();
+const scan = (source) => scanImports(encoder.encode(source));
+
+assertDeepEqual(scan(`
+import a from './a.js';
+import { b, c as d } from "./b.js";
+import * as ns from './ns.js';
+import './side.js';
+export * from './star.js';
+export { e } from './e.js';
+export { f };
+`), ['./a.js', './b.js', './ns.js', './side.js', './star.js', './e.js']);
+
+// only statements count
+assertDeepEqual(scan(`
+// import a from './comment.js'
+const s = "import b from './string.js'";
+const t = \`\${x} import c from './template.js'\`;
+const r = /import d from '.\\/regexp.js'/;
+import('./dynamic.js');
+console.log(import.meta.url);
+`), []);
+
+import('../fixtures/prefetch/a.js')
+  .then(({ a }) => {
+    assertEqual(a, 3);
+    pass();
+  })
+  .catch(fail);
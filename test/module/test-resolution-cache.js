@@ -0,0 +1,35 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const late = new URL('resolution_late.js', fixtures);
+
+const failsToImport = async (specifier) => {
+  try {
+    await import(specifier);
+    return false;
+  } catch (e) {
+    return true;
+  }
+};
+
+(async () => {
+  const before = environment.resolutionStats;
+
+  const { one } = await import('../fixtures/export-one');
+  assertEqual(one, 1);
+  await import('../fixtures/export-one');
+  const after = environment.resolutionStats;
+  assertEqual(after.misses, before.misses + 1);
+  assertEqual(after.hits, before.hits + 1);
+
+  // missing files are cached too, until the directory is invalidated
+  assertEqual(await failsToImport('../fixtures/resolution_late'), true);
+  await fileSystem.writeFile(late, 'export default 2;');
+  assertEqual(await failsToImport('../fixtures/resolution_late'), true);
+
+  environment.invalidateResolution(fixtures);
+  const { default: two } = await import('../fixtures/resolution_late');
+  assertEqual(two, 2);
+  assertEqual(environment.resolutionStats.invalidations, before.invalidations + 1);
+
+  await fileSystem.removeFile(late);
+})().then(pass).catch(fail);
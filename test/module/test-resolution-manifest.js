@@ -0,0 +1,28 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const manifest = new URL('manifest.json', fixtures);
+
+(async () => {
+  await import('../fixtures/prefetch/a.js');
+  await environment.writeResolutionManifest(manifest);
+  const { imports } = JSON.parse(await fileSystem.readFile(manifest, { encoding: 'utf8' }));
+  assertEqual(imports[`${fixtures}prefetch/a.js`], `${fixtures}prefetch/a.js`);
+  assertEqual(imports[`${fixtures}prefetch/c`], `${fixtures}prefetch/c.js`);
+
+  // entries are trusted without looking at the file system
+  await fileSystem.writeFile(manifest, JSON.stringify({
+    imports: {
+      './missing.js': './prefetch/b.js',
+      bare: './prefetch/c.js',
+    },
+  }));
+  await environment.loadResolutionManifest(manifest);
+  assertEqual(environment.resolutionStats.manifestEntries, 1);
+
+  const { manifestHits } = environment.resolutionStats;
+  const { b } = await import('../fixtures/missing.js');
+  assertEqual(b, 2);
+  assertEqual(environment.resolutionStats.manifestHits, manifestHits + 1);
+
+  await fileSystem.removeFile(manifest);
+})().then(pass).catch(fail);
@@ -0,0 +1,27 @@
+import { pass, fail, assertEqual, fixtures } from '../common';
+
+const { runStreaming } = binding('script_wrap'); // eslint-disable-line no-undef
+
+const url = new URL('streaming_script.js', fixtures);
+
+const rejection = async (promise) => {
+  try {
+    await promise;
+  } catch (e) {
+    return e;
+  }
+  throw new Error('expected a rejection');
+};
+
+(async () => {
+  // many chunks, with multi-byte characters split between them
+  await fileSystem.writeFile(url, `${'// ☃☃☃\n'.repeat(30000)}'done ☃' + 1;`);
+  assertEqual(await runStreaming(`${url}`, url.pathname), 'done ☃1');
+
+  await fileSystem.writeFile(url, 'var streamed = ;');
+  assertEqual((await rejection(runStreaming(`${url}`, url.pathname))) instanceof SyntaxError, true);
+
+  await fileSystem.removeFile(url);
+  const error = await rejection(runStreaming(`${url}`, url.pathname));
+  assertEqual(typeof error.code, 'number');
+})().then(pass).catch(fail);
@@ -0,0 +1,13 @@
+import { pass, fail, assert } from '../common';
+
+const { postDelayedWorkerTask } = binding('platform'); // eslint-disable-line no-undef
+const { now } = binding('performance'); // eslint-disable-line no-undef
+
+const start = now();
+const timeout = setTimeout(() => fail('delayed worker task did not run'), 5000);
+
+postDelayedWorkerTask(50, () => {
+  clearTimeout(timeout);
+  assert(now() - start >= 50);
+  pass();
+});
@@ -0,0 +1,28 @@
+import { pass, fail, assertDeepEqual } from '../common';
+
+const order = [];
+
+setTimeout(() => order.push('b'), 20);
+setTimeout(() => order.push('a'), 10);
+setTimeout(() => order.push('c'), 20);
+
+const cleared = setTimeout(() => fail('cleared timer ran'), 10);
+clearTimeout(cleared);
+
+// clearing a timer that is due in the same turn keeps it from running
+setTimeout(() => clearTimeout(late), 30);
+const late = setTimeout(() => fail('timer cleared in the same turn ran'), 30);
+
+let ticks = 0;
+const interval = setInterval(() => {
+  ticks += 1;
+  order.push(`i${ticks}`);
+  if (ticks === 3) {
+    clearInterval(interval);
+  }
+}, 15);
+
+setTimeout(() => {
+  assertDeepEqual(['a', 'i1', 'b', 'c', 'i2', 'i3'], order);
+  pass();
+}, 100);